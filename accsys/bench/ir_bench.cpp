@@ -0,0 +1,601 @@
+#include "ir/type.h"
+#include "ir/ir.h"
+#include "ir/dominators.h"
+#include "ir/loop_info.h"
+
+#include <fmt/core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// usage: IRBench [--filter=<substring>] [--min-time=<seconds>] [--repeat=N]
+//                [--json] [--out=<file>] [--list]
+// Times the hot primitives of the IR library. Every benchmark is run with
+// a growing iteration count until one run takes --min-time, then that
+// count is rerun --repeat times and the fastest run is kept. Results are
+// printed as a table, or as JSON with --json / --out. The JSON follows the
+// schema of google-benchmark, so its compare tooling works on two result
+// files taken before and after a change of the library.
+
+namespace {
+
+/// Keep the compiler from optimizing away a result the benchmark computes.
+template <typename T> inline void doNotOptimize(const T &Val) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(Val) : "memory");
+#else
+    static volatile const void *Sink;
+    Sink = &Val;
+#endif
+}
+
+/// Timing state handed to a benchmark body. The body performs one
+/// operation per keepRunning() call, setup and teardown inside the loop
+/// are kept out of the measurement with pauseTiming() / resumeTiming().
+class BenchState {
+public:
+    explicit BenchState(std::uint64_t Iterations)
+        : Iterations(Iterations), Remaining(Iterations) {}
+
+    bool keepRunning() {
+        if (Remaining == Iterations && !Running)
+            resumeTiming();
+        if (Remaining > 0) {
+            --Remaining;
+            return true;
+        }
+        pauseTiming();
+        return false;
+    }
+
+    void pauseTiming() {
+        if (!Running)
+            return;
+        WallNs += std::chrono::duration<double, std::nano>(Clock::now() - WallStart).count();
+        CpuNs += double(std::clock() - CpuStart) * 1e9 / CLOCKS_PER_SEC;
+        Running = false;
+    }
+
+    void resumeTiming() {
+        if (Running)
+            return;
+        Running = true;
+        CpuStart = std::clock();
+        WallStart = Clock::now();
+    }
+
+    std::uint64_t getIterations() const { return Iterations; }
+    double getWallNs() const { return WallNs; }
+    double getCpuNs() const { return CpuNs; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::uint64_t Iterations;
+    std::uint64_t Remaining;
+    bool Running = false;
+    Clock::time_point WallStart;
+    std::clock_t CpuStart = 0;
+    double WallNs = 0;
+    double CpuNs = 0;
+};
+
+using BenchFn = void (*)(BenchState &);
+
+struct BenchCase {
+    std::string Name;
+    BenchFn Fn;
+};
+
+struct BenchResult {
+    std::string Name;
+    std::uint64_t Iterations;
+    double RealNs;
+    double CpuNs;
+};
+
+/// Stream buffer that drops everything, so Module::print can be timed
+/// without the cost of a real sink.
+class NullBuffer: public std::streambuf {
+protected:
+    std::streamsize xsputn(const char *, std::streamsize N) override { return N; }
+    int_type overflow(int_type C) override { return traits_type::not_eof(C); }
+};
+
+/// Instructions created between two clean-ups of the created-into block,
+/// bounding the memory of the creation benchmarks.
+constexpr unsigned BatchSize = 4096;
+
+/// A module with a function 'int f(int)' whose entry block holds the
+/// values the benchmarks use as operands, and a work block to create
+/// instructions into. The work block ends with an anchor 'ret' that
+/// the InsertBefore overloads insert before.
+struct Fixture {
+    std::unique_ptr<Module> M = std::make_unique<Module>();
+    Type *IntTy = Type::getIntegerTy();
+    Function *Callee;
+    Function *F;
+    BasicBlock *Entry;
+    BasicBlock *Work;
+    BasicBlock *Exit;
+    ConstantInt *Zero = ConstantInt::Create(0);
+    ConstantInt *One = ConstantInt::Create(1);
+    ConstantInt *Two = ConstantInt::Create(2);
+    AllocaInst *Scalar;
+    AllocaInst *Array;
+    RetInst *Anchor;
+
+    Fixture() {
+        FunctionType *FT = FunctionType::get(IntTy, {IntTy});
+        Callee = Function::Create(FT, true, "callee", M.get());
+        F = Function::Create(FT, false, "f", M.get());
+        Entry = BasicBlock::Create(F);
+        Work = BasicBlock::Create(F);
+        Exit = BasicBlock::Create(F);
+        Scalar = AllocaInst::Create(IntTy, 1, Entry);
+        Array = AllocaInst::Create(IntTy, 16, Entry);
+        JumpInst::Create(Work, Entry);
+        Anchor = RetInst::Create(Zero, Work);
+        RetInst::Create(One, Exit);
+    }
+
+    ~Fixture() {
+        M.reset();
+        delete Zero;
+        delete One;
+        delete Two;
+    }
+
+    /// Erase everything created into the work block, keeping the anchor.
+    void clearWork() {
+        while (&Work->front() != Anchor)
+            Work->front().eraseFromParent();
+    }
+};
+
+/// Time one creation overload. The AtEnd form appends to the work block,
+/// the Before form inserts before its anchor.
+template <typename CreateFn>
+void benchCreate(BenchState &S, bool AtEnd, CreateFn Create) {
+    Fixture Fx;
+    unsigned Batch = 0;
+    while (S.keepRunning()) {
+        if (AtEnd)
+            doNotOptimize(Create(Fx, Fx.Work));
+        else
+            doNotOptimize(Create(Fx, static_cast<Instruction *>(Fx.Anchor)));
+        if (++Batch == BatchSize) {
+            S.pauseTiming();
+            // Instructions appended at the end follow the anchor.
+            while (&Fx.Work->back() != Fx.Anchor)
+                Fx.Work->back().eraseFromParent();
+            Fx.clearWork();
+            Batch = 0;
+            S.resumeTiming();
+        }
+    }
+}
+
+#define ACCSYS_CREATE_BENCH(Kind, Body)                                     \
+    void BM_Create##Kind##AtEnd(BenchState &S) {                            \
+        benchCreate(S, true, []([[maybe_unused]] Fixture &Fx, auto *Pos) {  \
+            return Body;                                                    \
+        });                                                                 \
+    }                                                                       \
+    void BM_Create##Kind##Before(BenchState &S) {                           \
+        benchCreate(S, false, []([[maybe_unused]] Fixture &Fx, auto *Pos) { \
+            return Body;                                                    \
+        });                                                                 \
+    }
+
+ACCSYS_CREATE_BENCH(Binary, BinaryInst::Create(Instruction::Add, Fx.One, Fx.Two, Fx.IntTy, Pos))
+ACCSYS_CREATE_BENCH(Alloca, AllocaInst::Create(Fx.IntTy, 4, Pos))
+ACCSYS_CREATE_BENCH(Load, LoadInst::Create(Fx.Scalar, Pos))
+ACCSYS_CREATE_BENCH(Store, StoreInst::Create(Fx.One, Fx.Scalar, Pos))
+ACCSYS_CREATE_BENCH(Offset, ([&] {
+    std::vector<Value *> Indices {Fx.One, Fx.Two};
+    std::vector<std::optional<std::size_t>> Bounds {std::nullopt, 4};
+    return OffsetInst::Create(Fx.IntTy, Fx.Array, Indices, Bounds, Pos);
+}()))
+ACCSYS_CREATE_BENCH(Call, CallInst::Create(Fx.Callee, {Fx.One}, Pos))
+ACCSYS_CREATE_BENCH(Ret, RetInst::Create(Fx.One, Pos))
+ACCSYS_CREATE_BENCH(Jump, JumpInst::Create(Fx.Exit, Pos))
+ACCSYS_CREATE_BENCH(Branch, BranchInst::Create(Fx.Work, Fx.Exit, Fx.One, Pos))
+ACCSYS_CREATE_BENCH(Panic, PanicInst::Create(Pos))
+
+#undef ACCSYS_CREATE_BENCH
+
+void BM_UseSet(BenchState &S) {
+    Fixture Fx;
+    BinaryInst *Add = BinaryInst::CreateAdd(Fx.One, Fx.Two, Fx.IntTy, Fx.Anchor);
+    Use &LHS = Add->getOperandUse(0);
+    bool Flip = false;
+    while (S.keepRunning()) {
+        LHS.set(Flip ? Fx.One : Fx.Zero);
+        Flip = !Flip;
+    }
+}
+
+/// replaceAllUsesWith of a value with NumUses loads using it, back and forth
+/// between two allocas.
+template <unsigned NumUses> void BM_ReplaceAllUsesWith(BenchState &S) {
+    Fixture Fx;
+    for (unsigned i = 0; i < NumUses; ++i)
+        LoadInst::Create(Fx.Scalar, Fx.Anchor);
+    Value *From = Fx.Scalar, *To = Fx.Array;
+    while (S.keepRunning()) {
+        From->replaceAllUsesWith(To);
+        std::swap(From, To);
+    }
+}
+
+/// Unlink an instruction and link it back, the bare List insert/remove.
+void BM_ListInsertRemove(BenchState &S) {
+    Fixture Fx;
+    LoadInst *Load = LoadInst::Create(Fx.Scalar);
+    while (S.keepRunning()) {
+        Load->insertBefore(Fx.Anchor);
+        Load->removeFromParent();
+    }
+    delete Load;
+}
+
+void BM_ListErase(BenchState &S) {
+    Fixture Fx;
+    unsigned Batch = 0;
+    while (S.keepRunning()) {
+        if (Batch == 0) {
+            S.pauseTiming();
+            for (unsigned i = 0; i < BatchSize; ++i)
+                LoadInst::Create(Fx.Scalar, Fx.Anchor);
+            Batch = BatchSize;
+            S.resumeTiming();
+        }
+        Fx.Work->front().eraseFromParent();
+        --Batch;
+    }
+}
+
+template <unsigned Length> void BM_ListSize(BenchState &S) {
+    Fixture Fx;
+    for (unsigned i = 1; i < Length; ++i)
+        LoadInst::Create(Fx.Scalar, Fx.Anchor);
+    while (S.keepRunning())
+        doNotOptimize(Fx.Work->size());
+}
+
+/// Move the Length - 1 loads in front of the anchor to the exit block and back.
+template <unsigned Length> void BM_ListSplice(BenchState &S) {
+    Fixture Fx;
+    for (unsigned i = 1; i < Length; ++i)
+        LoadInst::Create(Fx.Scalar, Fx.Anchor);
+    while (S.keepRunning()) {
+        Fx.Exit->splice(Fx.Exit->begin(), Fx.Work, Fx.Work->begin(), BasicBlock::iterator(Fx.Anchor));
+        Fx.Work->splice(Fx.Work->begin(), Fx.Exit, Fx.Exit->begin(),
+                        BasicBlock::iterator(Fx.Exit->getTerminator()));
+    }
+}
+
+/// Order queries between the ends of a block, after every insertion in
+/// the middle (Renumber) or without any (Cached).
+template <unsigned Length, bool Renumber> void BM_ComesBefore(BenchState &S) {
+    Fixture Fx;
+    for (unsigned i = 1; i < Length; ++i)
+        LoadInst::Create(Fx.Scalar, Fx.Anchor);
+    Instruction *First = &Fx.Work->front();
+    LoadInst *Moved = LoadInst::Create(Fx.Scalar);
+    Moved->insertBefore(Fx.Anchor);
+    while (S.keepRunning()) {
+        if (Renumber) {
+            Moved->removeFromParent();
+            Moved->insertAfter(First);
+        }
+        doNotOptimize(First->comesBefore(Fx.Anchor));
+    }
+}
+
+/// Constant offset of a NumDims dimensional access into int[4][4]...
+template <unsigned NumDims> void BM_AccumulateConstantOffset(BenchState &S) {
+    Fixture Fx;
+    std::vector<Value *> Indices(NumDims, Fx.One);
+    std::vector<std::optional<std::size_t>> Bounds(NumDims, 4);
+    Bounds[0] = std::nullopt;
+    OffsetInst *Off = OffsetInst::Create(Fx.IntTy, Fx.Array, Indices, Bounds, Fx.Anchor);
+    while (S.keepRunning()) {
+        std::size_t Offset = 0;
+        doNotOptimize(Off->accumulateConstantOffset(Offset));
+        doNotOptimize(Offset);
+    }
+}
+
+void BM_PointerTypeGet(BenchState &S) {
+    Type *IntTy = Type::getIntegerTy();
+    Type *PtrTy = PointerType::get(IntTy);
+    bool Flip = false;
+    while (S.keepRunning()) {
+        doNotOptimize(PointerType::get(Flip ? IntTy : PtrTy));
+        Flip = !Flip;
+    }
+}
+
+/// FunctionType::get of an already seen signature.
+void BM_FunctionTypeGet(BenchState &S) {
+    Type *IntTy = Type::getIntegerTy();
+    Type *PtrTy = PointerType::get(IntTy);
+    while (S.keepRunning())
+        doNotOptimize(FunctionType::get(IntTy, {IntTy, PtrTy, IntTy}));
+}
+
+/// A module of NumFunctions functions, each a chain of anonymous
+/// instructions in a few blocks, so printing it numbers many slots.
+std::unique_ptr<Module> buildPrintModule(unsigned NumFunctions) {
+    auto M = std::make_unique<Module>();
+    Type *IntTy = Type::getIntegerTy();
+    FunctionType *FT = FunctionType::get(IntTy, {IntTy, PointerType::get(IntTy)});
+    GlobalVariable *G = GlobalVariable::Create(IntTy, 1, false, "g", M.get());
+    for (unsigned f = 0; f < NumFunctions; ++f) {
+        Function *F = Function::Create(FT, false, fmt::format("f{}", f), M.get());
+        BasicBlock *BB = BasicBlock::Create(F);
+        Value *Acc = F->getArg(0);
+        for (unsigned b = 0; b < 8; ++b) {
+            for (unsigned i = 0; i < 32; ++i) {
+                Value *Load = LoadInst::Create(i % 2 ? static_cast<Value *>(G) : F->getArg(1), BB);
+                Acc = BinaryInst::CreateAdd(Acc, Load, IntTy, BB);
+            }
+            BasicBlock *Next = BasicBlock::Create(F);
+            JumpInst::Create(Next, BB);
+            BB = Next;
+        }
+        RetInst::Create(Acc, BB);
+    }
+    return M;
+}
+
+/// Module::print, which builds the slot tracker of every function it
+/// writes, formats them with NumThreads threads and writes once.
+template <unsigned NumThreads> void BM_ModulePrint(BenchState &S) {
+    auto M = buildPrintModule(64);
+    NullBuffer Buffer;
+    std::ostream OS(&Buffer);
+    while (S.keepRunning())
+        M->print(OS, false, NumThreads);
+}
+
+/// Dominator tree of NumLoops while loops in a row, built from scratch
+/// (Update false) or updated as the break of the middle loop is
+/// retargeted between the next loop and the exit (Update true).
+template <unsigned NumLoops, bool Update> void BM_DominatorTree(BenchState &S) {
+    Module M;
+    Type *IntTy = Type::getIntegerTy();
+    Function *F = Function::Create(FunctionType::get(IntTy, {IntTy}), false, "f", &M);
+    Value *C = F->getArg(0);
+    std::vector<BasicBlock *> Conds;
+    for (unsigned i = 0; i <= NumLoops; ++i)
+        Conds.push_back(BasicBlock::Create(F));
+    BasicBlock *Exit = Conds.back();
+    BranchInst *Break = nullptr;
+    for (unsigned i = 0; i < NumLoops; ++i) {
+        BasicBlock *Body = BasicBlock::Create(F);
+        BranchInst::Create(Body, Conds[i + 1], C, Conds[i]);
+        BranchInst *Br = BranchInst::Create(Conds[i], Conds[i + 1], C, Body);
+        if (i == NumLoops / 2)
+            Break = Br;
+    }
+    RetInst::Create(C, Exit);
+    DominatorTree DT(*F);
+    BasicBlock *Targets[2] = {Break->getFalseBB(), Exit};
+    unsigned Current = 0;
+    while (S.keepRunning()) {
+        if (Update) {
+            BasicBlock *Old = Targets[Current];
+            Current ^= 1;
+            Break->setFalseBB(Targets[Current]);
+            DT.deleteEdge(Break->getParent(), Old);
+            DT.insertEdge(Break->getParent(), Targets[Current]);
+        } else {
+            DT.recalculate(*F);
+        }
+        doNotOptimize(DT.getRootNode());
+    }
+}
+
+/// Loop nesting forest of NumLoops while loops in a row, each with a
+/// nested while loop, from an up to date dominator tree.
+template <unsigned NumLoops> void BM_LoopInfo(BenchState &S) {
+    Module M;
+    Type *IntTy = Type::getIntegerTy();
+    Function *F = Function::Create(FunctionType::get(IntTy, {IntTy}), false, "f", &M);
+    Value *C = F->getArg(0);
+    std::vector<BasicBlock *> Conds;
+    for (unsigned i = 0; i <= NumLoops; ++i)
+        Conds.push_back(BasicBlock::Create(F));
+    for (unsigned i = 0; i < NumLoops; ++i) {
+        BasicBlock *InnerCond = BasicBlock::Create(F);
+        BasicBlock *InnerBody = BasicBlock::Create(F);
+        BasicBlock *After = BasicBlock::Create(F);
+        BranchInst::Create(InnerCond, Conds[i + 1], C, Conds[i]);
+        BranchInst::Create(InnerBody, After, C, InnerCond);
+        JumpInst::Create(InnerCond, InnerBody);
+        JumpInst::Create(Conds[i], After);
+    }
+    RetInst::Create(C, Conds.back());
+    DominatorTree DT(*F);
+    LoopInfo LI;
+    while (S.keepRunning()) {
+        LI.analyze(DT);
+        doNotOptimize(LI.getTopLevelLoops().data());
+    }
+}
+
+const BenchCase Cases[] = {
+    {"Create/Binary/AtEnd", BM_CreateBinaryAtEnd},
+    {"Create/Binary/Before", BM_CreateBinaryBefore},
+    {"Create/Alloca/AtEnd", BM_CreateAllocaAtEnd},
+    {"Create/Alloca/Before", BM_CreateAllocaBefore},
+    {"Create/Load/AtEnd", BM_CreateLoadAtEnd},
+    {"Create/Load/Before", BM_CreateLoadBefore},
+    {"Create/Store/AtEnd", BM_CreateStoreAtEnd},
+    {"Create/Store/Before", BM_CreateStoreBefore},
+    {"Create/Offset/AtEnd", BM_CreateOffsetAtEnd},
+    {"Create/Offset/Before", BM_CreateOffsetBefore},
+    {"Create/Call/AtEnd", BM_CreateCallAtEnd},
+    {"Create/Call/Before", BM_CreateCallBefore},
+    {"Create/Ret/AtEnd", BM_CreateRetAtEnd},
+    {"Create/Ret/Before", BM_CreateRetBefore},
+    {"Create/Jump/AtEnd", BM_CreateJumpAtEnd},
+    {"Create/Jump/Before", BM_CreateJumpBefore},
+    {"Create/Branch/AtEnd", BM_CreateBranchAtEnd},
+    {"Create/Branch/Before", BM_CreateBranchBefore},
+    {"Create/Panic/AtEnd", BM_CreatePanicAtEnd},
+    {"Create/Panic/Before", BM_CreatePanicBefore},
+    {"Use/Set", BM_UseSet},
+    {"Value/ReplaceAllUsesWith/1", BM_ReplaceAllUsesWith<1>},
+    {"Value/ReplaceAllUsesWith/16", BM_ReplaceAllUsesWith<16>},
+    {"Value/ReplaceAllUsesWith/256", BM_ReplaceAllUsesWith<256>},
+    {"List/InsertRemove", BM_ListInsertRemove},
+    {"List/Erase", BM_ListErase},
+    {"List/Size/16", BM_ListSize<16>},
+    {"List/Size/1024", BM_ListSize<1024>},
+    {"List/Splice/16", BM_ListSplice<16>},
+    {"List/Splice/1024", BM_ListSplice<1024>},
+    {"Instruction/ComesBefore/Cached/1024", BM_ComesBefore<1024, false>},
+    {"Instruction/ComesBefore/Renumber/16", BM_ComesBefore<16, true>},
+    {"Instruction/ComesBefore/Renumber/1024", BM_ComesBefore<1024, true>},
+    {"Offset/AccumulateConstantOffset/1", BM_AccumulateConstantOffset<1>},
+    {"Offset/AccumulateConstantOffset/3", BM_AccumulateConstantOffset<3>},
+    {"Type/PointerTypeGet", BM_PointerTypeGet},
+    {"Type/FunctionTypeGet", BM_FunctionTypeGet},
+    {"Module/Print/Threads:1", BM_ModulePrint<1>},
+    {"Module/Print/Threads:4", BM_ModulePrint<4>},
+    {"DominatorTree/Recalculate/512", BM_DominatorTree<512, false>},
+    {"DominatorTree/UpdateEdge/512", BM_DominatorTree<512, true>},
+    {"LoopInfo/Analyze/512", BM_LoopInfo<512>},
+};
+
+/// Grow the iteration count until a run takes MinTime seconds, then keep
+/// the fastest of Repeat runs of that count.
+BenchResult runCase(const BenchCase &Case, double MinTime, unsigned Repeat) {
+    const double MinNs = MinTime * 1e9;
+    std::uint64_t Iterations = 1;
+    BenchState Best(Iterations);
+    for (;;) {
+        BenchState S(Iterations);
+        Case.Fn(S);
+        Best = S;
+        if (S.getWallNs() >= MinNs || Iterations >= 1000000000)
+            break;
+        // aim past MinTime, but grow at most tenfold on a noisy short run
+        double Scale = S.getWallNs() > MinNs / 10 ? MinNs * 1.4 / S.getWallNs() : 10;
+        Iterations = std::max<std::uint64_t>(Iterations + 1, std::uint64_t(Iterations * Scale));
+    }
+    for (unsigned r = 1; r < Repeat; ++r) {
+        BenchState S(Iterations);
+        Case.Fn(S);
+        if (S.getWallNs() < Best.getWallNs())
+            Best = S;
+    }
+    return {Case.Name, Iterations, Best.getWallNs() / Iterations, Best.getCpuNs() / Iterations};
+}
+
+std::string formatJSON(const std::vector<BenchResult> &Results, const char *Executable) {
+    char Date[32];
+    std::time_t Now = std::time(nullptr);
+    std::strftime(Date, sizeof(Date), "%Y-%m-%dT%H:%M:%S%z", std::localtime(&Now));
+#ifdef NDEBUG
+    const char *BuildType = "release";
+#else
+    const char *BuildType = "debug";
+#endif
+    std::string Out = "{\n  \"context\": {\n";
+    Out += fmt::format("    \"date\": \"{}\",\n", Date);
+    Out += fmt::format("    \"executable\": \"{}\",\n", Executable);
+    Out += fmt::format("    \"num_cpus\": {},\n", std::thread::hardware_concurrency());
+    Out += fmt::format("    \"library_build_type\": \"{}\"\n", BuildType);
+    Out += "  },\n  \"benchmarks\": [";
+    for (std::size_t i = 0; i < Results.size(); ++i) {
+        const BenchResult &R = Results[i];
+        Out += i ? ",\n" : "\n";
+        Out += fmt::format("    {{\"name\": \"{}\", \"run_name\": \"{}\", \"run_type\": \"iteration\", "
+                           "\"iterations\": {}, \"real_time\": {:.3f}, \"cpu_time\": {:.3f}, "
+                           "\"time_unit\": \"ns\"}}",
+                           R.Name, R.Name, R.Iterations, R.RealNs, R.CpuNs);
+    }
+    Out += "\n  ]\n}\n";
+    return Out;
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    std::string Filter;
+    std::string OutFile;
+    double MinTime = 0.1;
+    unsigned Repeat = 3;
+    bool PrintJSON = false;
+    bool List = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view Arg = argv[i];
+        if (Arg.rfind("--filter=", 0) == 0)
+            Filter = Arg.substr(9);
+        else if (Arg.rfind("--min-time=", 0) == 0)
+            MinTime = std::atof(argv[i] + 11);
+        else if (Arg.rfind("--repeat=", 0) == 0)
+            Repeat = std::max(1, std::atoi(argv[i] + 9));
+        else if (Arg.rfind("--out=", 0) == 0)
+            OutFile = Arg.substr(6);
+        else if (Arg == "--json")
+            PrintJSON = true;
+        else if (Arg == "--list")
+            List = true;
+        else {
+            fmt::print(stderr, "unknown option: {}\n", Arg);
+            return 1;
+        }
+    }
+
+    std::vector<BenchResult> Results;
+    if (!PrintJSON && !List)
+        fmt::print("{:<36}  {:>12}  {:>12}  {:>12}\n", "benchmark", "iterations", "ns/op", "cpu ns/op");
+    for (const BenchCase &Case : Cases) {
+        if (Case.Name.find(Filter) == std::string::npos)
+            continue;
+        if (List) {
+            fmt::print("{}\n", Case.Name);
+            continue;
+        }
+        Results.push_back(runCase(Case, MinTime, Repeat));
+        const BenchResult &R = Results.back();
+        if (!PrintJSON) {
+            fmt::print("{:<36}  {:>12}  {:>12.2f}  {:>12.2f}\n", R.Name, R.Iterations, R.RealNs, R.CpuNs);
+            std::fflush(stdout);
+        }
+    }
+    if (List)
+        return 0;
+
+    std::string JSON = formatJSON(Results, argv[0]);
+    if (PrintJSON)
+        fmt::print("{}", JSON);
+    if (!OutFile.empty()) {
+        std::FILE *Out = std::fopen(OutFile.c_str(), "w");
+        if (!Out) {
+            fmt::print(stderr, "cannot open {}\n", OutFile);
+            return 1;
+        }
+        std::fwrite(JSON.data(), 1, JSON.size(), Out);
+        std::fclose(Out);
+    }
+    return 0;
+}
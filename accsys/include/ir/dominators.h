@@ -0,0 +1,191 @@
+#pragma once
+
+#include "ir/ir.h"
+#include "utils/indexed_map.h"
+
+#include <memory>
+#include <vector>
+
+template <bool IsPostDom> class DominatorTreeBase;
+
+/// \brief DomTreeNode is a basic block in a dominator tree, with its
+/// immediate dominator and the blocks it immediately dominates.
+/// The virtual root of a post-dominator tree has no block.
+class DomTreeNode {
+    BasicBlock *Block;
+    DomTreeNode *IDom;
+    std::vector<DomTreeNode *> Children;
+    // Depth in the tree, the root is at level 0.
+    unsigned Level;
+    // Preorder and postorder numbers of a walk of the tree, while the tree
+    // says they are valid. See dominatedBy.
+    unsigned DFSNumIn = ~0u;
+    unsigned DFSNumOut = ~0u;
+
+    template <bool IsPostDom> friend class DominatorTreeBase;
+
+    /// Move the node under NewIDom, its subtree levels are left stale.
+    void setIDom(DomTreeNode *NewIDom);
+public:
+    DomTreeNode(BasicBlock *Block, DomTreeNode *IDom)
+        : Block(Block), IDom(IDom), Level(IDom ? IDom->Level + 1 : 0) {}
+    DomTreeNode(const DomTreeNode &) = delete;
+    DomTreeNode &operator=(const DomTreeNode &) = delete;
+
+    using const_iterator = std::vector<DomTreeNode *>::const_iterator;
+
+    BasicBlock *getBlock() const { return Block; }
+    DomTreeNode *getIDom() const { return IDom; }
+    unsigned getLevel() const { return Level; }
+    const std::vector<DomTreeNode *> &children() const { return Children; }
+    const_iterator begin() const { return Children.begin(); }
+    const_iterator end() const { return Children.end(); }
+    std::size_t getNumChildren() const { return Children.size(); }
+
+    unsigned getDFSNumIn() const { return DFSNumIn; }
+    unsigned getDFSNumOut() const { return DFSNumOut; }
+    /// Return true if Other is this node or one of its ancestors, by the
+    /// DFS interval numbers. They must be up to date.
+    bool dominatedBy(const DomTreeNode *Other) const {
+        return DFSNumIn >= Other->DFSNumIn && DFSNumOut <= Other->DFSNumOut;
+    }
+};
+
+/// \brief DominatorTreeBase is the dominator tree of a function, or its
+/// post-dominator tree if IsPostDom is set.
+///
+/// The tree is built with the Semi-NCA algorithm. Nodes are kept by block
+/// number, so renumbering the blocks of the function (see
+/// Function::renumberValues) requires a recalculation.
+/// Dominance queries are constant time with the DFS interval numbers of
+/// the tree, which are renumbered lazily after the tree changes.
+///
+/// A dominator tree only has the blocks reachable from the entry block.
+/// A post-dominator tree has every block under a virtual root, whose
+/// children are the blocks without successors plus one block of every
+/// region that cannot reach one of them, e.g. an infinite loop.
+///
+/// After a single edge is added to or removed from the CFG, insertEdge
+/// and deleteEdge update the tree in place, looking only at the part of
+/// the tree the edge may change.
+template <bool IsPostDom>
+class DominatorTreeBase {
+    Function *Parent = nullptr;
+    // By block number, null if the block is not in the tree.
+    std::vector<std::unique_ptr<DomTreeNode>> Nodes;
+    // The root of a post-dominator tree, which has no block.
+    std::unique_ptr<DomTreeNode> VirtualRoot;
+    DomTreeNode *RootNode = nullptr;
+    std::vector<BasicBlock *> Roots;
+    // Whether every root of a post-dominator tree is a block without
+    // successors. Edge updates only handle that case in place.
+    bool ExitRootsOnly = true;
+    mutable bool DFSInfoValid = false;
+    // Queries answered by walking the tree since it last changed.
+    mutable unsigned SlowQueries = 0;
+
+    DomTreeNode *createNode(BasicBlock *BB, DomTreeNode *IDom);
+    static DomTreeNode *findNearestCommonDominator(DomTreeNode *A, DomTreeNode *B);
+    void insertReachable(DomTreeNode *From, DomTreeNode *To);
+    void insertUnreachable(DomTreeNode *From, BasicBlock *To);
+    void rebuildSubtree(DomTreeNode *Top);
+    static void updateLevels(DomTreeNode *Top);
+public:
+    DominatorTreeBase() = default;
+    explicit DominatorTreeBase(Function &F) { recalculate(F); }
+
+    static constexpr bool isPostDominator() { return IsPostDom; }
+
+    /// Build the tree of F from scratch.
+    void recalculate(Function &F);
+
+    Function *getParent() const { return Parent; }
+    /// Return the entry block, or the roots under the virtual root of a
+    /// post-dominator tree.
+    const std::vector<BasicBlock *> &getRoots() const { return Roots; }
+    DomTreeNode *getRootNode() const { return RootNode; }
+    /// Return the node of BB, null if it is not in the tree.
+    DomTreeNode *getNode(const BasicBlock *BB) const {
+        unsigned Idx = BB->getNumber();
+        return BB->getParent() == Parent && Idx < Nodes.size() ? Nodes[Idx].get() : nullptr;
+    }
+    DomTreeNode *operator[](const BasicBlock *BB) const { return getNode(BB); }
+    bool isReachableFromEntry(const BasicBlock *BB) const { return getNode(BB) != nullptr; }
+    /// Return the immediate dominator of BB, null for a root or a block
+    /// not in the tree.
+    BasicBlock *getIDom(const BasicBlock *BB) const {
+        DomTreeNode *N = getNode(BB);
+        return N && N->getIDom() ? N->getIDom()->getBlock() : nullptr;
+    }
+
+    /// Return true if A dominates B. A block dominates itself, and every
+    /// block dominates the ones not in the tree.
+    bool dominates(const DomTreeNode *A, const DomTreeNode *B) const;
+    bool dominates(const BasicBlock *A, const BasicBlock *B) const {
+        return dominates(getNode(A), getNode(B));
+    }
+    bool properlyDominates(const DomTreeNode *A, const DomTreeNode *B) const {
+        return A != B && dominates(A, B);
+    }
+    bool properlyDominates(const BasicBlock *A, const BasicBlock *B) const {
+        return A != B && dominates(A, B);
+    }
+    /// Instructions of the same block dominate the ones after them (before
+    /// them when post-dominating), and themselves.
+    bool dominates(const Instruction *A, const Instruction *B) const;
+
+    /// Return the nearest block dominating both A and B, null if there is
+    /// none in the tree.
+    BasicBlock *findNearestCommonDominator(BasicBlock *A, BasicBlock *B) const;
+
+    /// Add the new block BB, immediately dominated by IDom.
+    DomTreeNode *addNewBlock(BasicBlock *BB, BasicBlock *IDom);
+    /// Remove the node of BB, which must have no children.
+    void eraseNode(BasicBlock *BB);
+
+    /// Update the tree for the edge From -> To, just added to the CFG.
+    void insertEdge(BasicBlock *From, BasicBlock *To);
+    /// Update the tree for the edge From -> To, just removed from the CFG.
+    /// Nothing changes if another edge From -> To is left.
+    /// Retargeting a successor is a deletion followed by an insertion,
+    /// both reported after the change.
+    void deleteEdge(BasicBlock *From, BasicBlock *To);
+
+    /// Number the nodes by a walk of the tree for the interval queries.
+    void updateDFSNumbers() const;
+    /// Return true if the tree is the one recalculate would build.
+    bool verify() const;
+};
+
+using DominatorTree = DominatorTreeBase<false>;
+using PostDominatorTree = DominatorTreeBase<true>;
+
+extern template class DominatorTreeBase<false>;
+extern template class DominatorTreeBase<true>;
+
+/// \brief DominanceFrontierBase is the dominance frontier of every block,
+/// the blocks where its dominance ends: those it does not strictly
+/// dominate, but dominates a predecessor of. They are where SSA
+/// construction places its phis.
+/// Over a post-dominator tree these are the post-dominance frontiers, a
+/// block is control dependent on the blocks of its frontier.
+/// Computed with the algorithm of Cooper, Harvey and Kennedy, it has to be
+/// recalculated after the tree changes.
+template <bool IsPostDom>
+class DominanceFrontierBase {
+    IndexedMap<std::vector<BasicBlock *>, BlockNumberIndex> Frontiers;
+    const Function *Parent = nullptr;
+public:
+    DominanceFrontierBase() = default;
+    explicit DominanceFrontierBase(const DominatorTreeBase<IsPostDom> &DT) { calculate(DT); }
+
+    void calculate(const DominatorTreeBase<IsPostDom> &DT);
+    /// Return the frontier of BB, in no particular order.
+    const std::vector<BasicBlock *> &getFrontier(const BasicBlock *BB) const;
+};
+
+using DominanceFrontier = DominanceFrontierBase<false>;
+using PostDominanceFrontier = DominanceFrontierBase<true>;
+
+extern template class DominanceFrontierBase<false>;
+extern template class DominanceFrontierBase<true>;
@@ -3,9 +3,14 @@
 #include "ir/type.h"
 #include "utils/list.h"
 #include "utils/casting.h"
+#include "utils/alloc_stats.h"
+#include "utils/slab_allocator.h"
+#include "utils/string_pool.h"
+#include "utils/array_ref.h"
 
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -58,10 +63,7 @@ public:
 private:
     /// Priave constructor and destructor by design, 
     /// should be only called by subclasses of 'Value'.
-    ~Use() {
-        if (Val)
-            removeFromList();
-    }
+    ~Use();
     /// make emplace_back happy.
     explicit Use(Value *Parent);
 private:
@@ -82,6 +84,8 @@ public:
 
 class Value {
     const unsigned char SubclassID;
+    // Length of UserList, kept by addUse and removeUse.
+    unsigned NumUses = 0;
 protected:
     Value(Type *Ty, unsigned scid);
 
@@ -91,8 +95,14 @@ public:
     virtual ~Value();
 
     /// Inner Use list operation, should be only be called by Use.
-    void addUse(Use &U) { U.addToList(&UserList); }
-    void removeUse(Use &U) { U.removeFromList(); }
+    void addUse(Use &U) {
+        U.addToList(&UserList);
+        ++NumUses;
+    }
+    void removeUse(Use &U) {
+        U.removeFromList();
+        --NumUses;
+    }
 
     /// Traverse all the user of this 'Value'.
     /// 'def-use' chain maintained by a double linked list and
@@ -123,29 +133,40 @@ public:
 
     /// Return the user view of this value.
     [[nodiscard]] UserView getUserView() const { return UserView {.UserList = UserList}; }
-    /// Return the number of uses of this value.
+    /// Return the number of uses of this value, in constant time.
     /// Distinguish between Value's 'getNumUses' and Instructions's 'getNumOperands'.
-    [[nodiscard]] unsigned getNumUses() const;
+    [[nodiscard]] unsigned getNumUses() const { return NumUses; }
+    /// Return true if this value has no uses, exactly one use, exactly N uses
+    /// or at least N uses.
+    [[nodiscard]] bool use_empty() const { return NumUses == 0; }
+    [[nodiscard]] bool hasOneUse() const { return NumUses == 1; }
+    [[nodiscard]] bool hasNUses(unsigned N) const { return NumUses == N; }
+    [[nodiscard]] bool hasNUsesOrMore(unsigned N) const { return NumUses >= N; }
     /// \brief This is an important method if you'd like to write
     /// a optimization pass on Accipit IR. It replace all the uses 
     /// of this value with a new value V by tracing 'def-use' chain.
     /// This method ONLY ensures the updates of this value.
+    /// The use list is moved to V as a whole, in a single pass over it
+    /// and without allocating.
     void replaceAllUsesWith(Value *V);
 private:
     Type *Ty;
     Use *UserList = nullptr;
-    std::string Name;
+    // Kept in the string pool of the module, see setName.
+    InternedString Name;
 public:
     /// Return the type of the value.
     Type *getType() const { return Ty; }
-    /// Set the name of the value.
+    /// Set the name of the value. The name is interned in the string pool
+    /// of the module the value belongs to, or in a per thread pool for a
+    /// value not (yet) in a module.
     void setName(std::string_view);
     /// Check if the value has a name, such as %name.
     /// By default, the name of a value is empty (annoymous value).
     /// Annoymous value will be assigned a slot number in IR print, such as %1.
     bool hasName() const;
     /// Return the name of the value.
-    std::string_view getName() const { return Name; }
+    std::string_view getName() const { return Name.str(); }
 
     /// Enumeration of the subclass value kinds.
     enum ValueKind {
@@ -182,7 +203,13 @@ class ConstantInt: public Constant {
 protected:
     explicit ConstantInt(std::uint32_t Val);
 public:
+    ~ConstantInt() override;
+    /// Return the constant of value Val. Constants are uniqued, so two
+    /// constants are equal if and only if they are the same object.
+    /// Deleting a constant by hand drops it from the pool, the next
+    /// Create of its value builds a new one.
     static ConstantInt *Create(std::uint32_t Val);
+    ACCSYS_COUNTED_ALLOC(AllocKind::ConstantInt)
 
 public:
     /// Return the integer value of the constant.
@@ -197,7 +224,10 @@ class ConstantUnit: public Constant {
 protected:
     ConstantUnit();
 public:
+    ~ConstantUnit() override;
+    /// Return the unit constant, there is only one, see ConstantInt::Create.
     static ConstantUnit *Create();
+    ACCSYS_COUNTED_ALLOC(AllocKind::ConstantUnit)
     
     static bool classof(const Value *V) {
         return V->getValueID() == Value::ConstantUnitVal;
@@ -213,6 +243,16 @@ public:
     Instruction &operator=(const Instruction &) = delete;
     ~Instruction() override;
 
+    /// Instructions are allocated with their NumOps operands right in front
+    /// of them, from the module allocator A or the global heap if A is null,
+    /// see ACCSYS_SLAB_ALLOC. The constructor must be passed the same NumOps.
+    static void *operator new(std::size_t Size, SlabAllocator *A, unsigned NumOps);
+    static void operator delete(void *Ptr, std::size_t Size);
+
+    using InstListType = List<Instruction>;
+    using op_iterator = Use *;
+    using const_op_iterator = const Use *;
+protected:
     // All instructions has two explicit static constructing methods,
     // specifying the instruction parameters, operands and the insertion position.
     // The first one is to insert the instruction before a specified instruction.
@@ -220,22 +260,43 @@ public:
     // Basically, the constructor of Instruction is private, and the only way to create
     // an instruction is to call the static method 'Create'.
     // The memory management is handled implicitly by intrusive lists.
-    Instruction(Type *Ty, unsigned Opcode, 
-                const std::vector<Value *> &Ops,
+    // The NumOps operands start out empty and are set by the subclass.
+    Instruction(Type *Ty, unsigned Opcode, unsigned NumOps,
                 Instruction *InsertBefore);
-    Instruction(Type *Ty, unsigned Opcode, 
-                const std::vector<Value *> &Ops,
+    Instruction(Type *Ty, unsigned Opcode, unsigned NumOps,
                 BasicBlock *InsertAtEnd);
 
-    using InstListType = List<Instruction>;
-    using op_iterator = Use *;
-    using const_op_iterator = const Use *;
+    /// Set the operands from First on to Ops.
+    void initOperands(ArrayRef<Value *> Ops, unsigned First = 0);
+    /// Insert the instruction at the position given to the constructor.
+    /// Terminators with successors pass a null position to Instruction
+    /// and call this once their successors are set, so that the edges
+    /// are added to the CFG on insertion.
+    void insertAt(Instruction *InsertBefore);
+    void insertAt(BasicBlock *InsertAtEnd);
+    /// Remove the edges to the successors from the CFG, for the
+    /// destructors of the terminators with successors.
+    void dropSuccessorEdges();
 private:
-    unsigned NumUserOperands;
-    Use *Uses = nullptr;
+    // Bytes between the operand array and the instruction: the operand
+    // count recorded by operator new and the owner of the allocation.
+    // The count is only kept there.
+    static constexpr std::size_t OperandGap = sizeof(std::size_t) + SlabAllocator::OwnerSize;
+
+    // Dense number in the parent function, see Function::getNumValueNumbers.
+    unsigned Number = 0;
+    // Position in the parent block, valid while the block says so.
+    // See comesBefore.
+    mutable unsigned Order = 0;
     BasicBlock *Parent = nullptr;
 
+    void initUses();
     void setParent(BasicBlock *BB);
+    // The successor slot i of a Jump or Br, see getSuccessor.
+    BasicBlock *&getSuccessorRef(unsigned i);
+
+    friend class BasicBlock;
+    friend class Function;
 public:
     /// Insert an unlinked instruction into a basic block immediately before the specified instruction.
     void insertBefore(Instruction *InsertPos);
@@ -248,19 +309,32 @@ public:
     InstListType::iterator insertInto(BasicBlock *ParentBB, InstListType::iterator IT);
 
  	// This method unlinks 'this' from the containing basic block, but does not delete it.
+    // The instruction is left without a parent.
     void removeFromParent();
  	// This method unlinks 'this' from the containing basic block and deletes it.
     InstListType::iterator eraseFromParent();
 
     const BasicBlock *getParent() const { return Parent; }
     BasicBlock *getParent() { return Parent; }
+    /// Return true if this instruction comes before Other, both in the
+    /// same basic block. Constant time, but the first query after an
+    /// insertion into the block renumbers it.
+    bool comesBefore(const Instruction *Other) const;
+    /// Return the dense number of the instruction in its function, see
+    /// Function::getNumValueNumbers. Meaningless if it is not in a function.
+    unsigned getNumber() const { return Number; }
     /// Return the integer reptresentation of the instruction opcode enumeration,
     /// which can be 'BinaryOps', 'MemoryOps', 'TerminatorOps' or 'OtherOps'.
     unsigned getOpcode() const { return getValueID() - InstructionVal; }
     /// Return the operands (use information) of Instruction, represented by
     /// a 'Use' class.
-    const Use *getOperandList() const { return Uses; }
-    Use *getOperandList() { return Uses; }
+    const Use *getOperandList() const {
+        return reinterpret_cast<const Use *>(reinterpret_cast<const char *>(this) - OperandGap) -
+               getNumOperands();
+    }
+    Use *getOperandList() {
+        return const_cast<Use *>(static_cast<const Instruction *>(this)->getOperandList());
+    }
     /// Return the i-th operand of the instruction.
     Value *getOperand(unsigned i) const {
         assert(i < getNumOperands() && "getOperand() out of range!");
@@ -273,17 +347,27 @@ public:
         return getOperandList()[index];
     }
     /// Return the number of operands of the instruction.
-    unsigned getNumOperands() const { return NumUserOperands; }
+    unsigned getNumOperands() const {
+        return *reinterpret_cast<const std::size_t *>(reinterpret_cast<const char *>(this) - OperandGap);
+    }
     /// Operands iteration.
     op_iterator op_begin() { return getOperandList(); }
     const_op_iterator op_begin() const { return getOperandList(); }
     op_iterator op_end() {
-        return getOperandList() + NumUserOperands;
+        return getOperandList() + getNumOperands();
     }
     const_op_iterator op_end() const {
-        return getOperandList() + NumUserOperands;
+        return getOperandList() + getNumOperands();
     }
 
+    /// Successors of a terminator, the blocks it may transfer control to.
+    /// Other instructions have none.
+    unsigned getNumSuccessors() const;
+    BasicBlock *getSuccessor(unsigned i) const;
+    /// Point successor i to BB, moving the CFG edge if the instruction is
+    /// in a basic block.
+    void setSuccessor(unsigned i, BasicBlock *BB);
+
     /// Check if the instruction has a binary opcode.
     bool isBinaryOp() const { return isBinaryOp(getOpcode()); }
     /// Check if the instruction has a terminator opcode.
@@ -441,13 +525,13 @@ public:
 
 class OffsetInst: public Instruction {
 protected:
-    OffsetInst(Type *PointeeTy,
-               std::vector <Value *> &Ops,
-               std::vector <std::optional<std::size_t>> &BoundList,
+    OffsetInst(Type *PointeeTy, Value *Ptr,
+               ArrayRef<Value *> Indices,
+               ArrayRef<std::optional<std::size_t>> BoundList,
                Instruction *InsertBefore = nullptr);
-    OffsetInst(Type *PointeeTy,
-               std::vector <Value *> &Ops,
-               std::vector <std::optional<std::size_t>> &BoundList,
+    OffsetInst(Type *PointeeTy, Value *Ptr,
+               ArrayRef<Value *> Indices,
+               ArrayRef<std::optional<std::size_t>> BoundList,
                BasicBlock *InsertAtEnd);
 private:
     Type *ElementTy;
@@ -460,13 +544,14 @@ private:
 
     void AssertOK() const;
 public:
+    /// Indices and Bounds may be given as vectors or braced lists.
     static OffsetInst *Create(Type *PointeeTy, Value *Ptr,
-                              std::vector <Value *> &Indices,
-                              std::vector <std::optional<std::size_t>> &Bounds,
+                              ArrayRef<Value *> Indices,
+                              ArrayRef<std::optional<std::size_t>> Bounds,
                               Instruction *InsertBefore = nullptr);
     static OffsetInst *Create(Type *PointeeTy, Value *Ptr,
-                              std::vector <Value *> &Indices,
-                              std::vector <std::optional<std::size_t>> &Boundss,
+                              ArrayRef<Value *> Indices,
+                              ArrayRef<std::optional<std::size_t>> Bounds,
                               BasicBlock *InsertAtEnd);
 
     using bound_iter = std::vector<std::optional<std::size_t>>::iterator;
@@ -508,14 +593,15 @@ public:
 
 class CallInst: public Instruction {
 protected:
-    CallInst(Function *Callee, const std::vector<Value *> &Args, Instruction *InsertBefore);
-    CallInst(Function *Callee, const std::vector<Value *> &Args, BasicBlock *InsertAtEnd);
+    CallInst(Function *Callee, ArrayRef<Value *> Args, Instruction *InsertBefore);
+    CallInst(Function *Callee, ArrayRef<Value *> Args, BasicBlock *InsertAtEnd);
 private:
     Function *Callee;
 public:
-    static CallInst *Create(Function *Callee, const std::vector<Value *> &Args, 
+    /// Args may be given as a vector or a braced list.
+    static CallInst *Create(Function *Callee, ArrayRef<Value *> Args, 
                             Instruction *InsertBefore = nullptr);
-    static CallInst *Create(Function *Callee, const std::vector<Value *> &Args, 
+    static CallInst *Create(Function *Callee, ArrayRef<Value *> Args, 
                             BasicBlock *InsertAtEnd);
     /// Return the callee function of the call instruction.
     Function *getCallee() const { return Callee; }
@@ -558,11 +644,15 @@ protected:
     JumpInst(BasicBlock *Dest, BasicBlock *InsertAtEnd);
 private:
     BasicBlock *Dest;
+
+    friend class Instruction;
 public:
+    ~JumpInst() override;
     static JumpInst *Create(BasicBlock *Dest, Instruction *InsertBefore = nullptr);
     static JumpInst *Create(BasicBlock *Dest, BasicBlock *InsertAtEnd);
     /// Return the destination basic block of the jump instruction.
     BasicBlock *getDestBasicBlock() const { return Dest; }
+    void setDestBasicBlock(BasicBlock *BB) { setSuccessor(0, BB); }
 
     static bool classof(const Instruction *I) {
         return I->getOpcode() == Instruction::Jump;
@@ -583,7 +673,10 @@ private:
     BasicBlock *IfFalse;
 
     void AssertOK() const;
+
+    friend class Instruction;
 public:
+    ~BranchInst() override;
     static BranchInst *Create(BasicBlock *IfTrue, BasicBlock *IfFalse, 
                               Value *Cond, 
                               Instruction *InsertBefore = nullptr);
@@ -596,6 +689,8 @@ public:
     BasicBlock *getTrueBB() const { return IfTrue; }
     /// Return the false branch basic block of the branch instruction.
     BasicBlock *getFalseBB() const { return IfFalse; }
+    void setTrueBB(BasicBlock *BB) { setSuccessor(0, BB); }
+    void setFalseBB(BasicBlock *BB) { setSuccessor(1, BB); }
 
     static bool classof(const Instruction *I) {
         return I->getOpcode() == Instruction::Br;
@@ -606,6 +701,25 @@ public:
     }
 };
 
+inline unsigned Instruction::getNumSuccessors() const {
+    switch (getOpcode()) {
+    case Jump: return 1;
+    case Br: return 2;
+    default: return 0;
+    }
+}
+
+inline BasicBlock *Instruction::getSuccessor(unsigned i) const {
+    return const_cast<Instruction *>(this)->getSuccessorRef(i);
+}
+
+inline BasicBlock *&Instruction::getSuccessorRef(unsigned i) {
+    assert(i < getNumSuccessors() && "getSuccessor() out of range!");
+    if (getOpcode() == Jump)
+        return static_cast<JumpInst *>(this)->Dest;
+    auto *Br = static_cast<BranchInst *>(this);
+    return i == 0 ? Br->IfTrue : Br->IfFalse;
+}
 
 
 /// Panic is a temporarily a placeholder terminator.
@@ -633,6 +747,8 @@ class BasicBlock final: public ListNode<BasicBlock> {
 public:
     BasicBlock(const BasicBlock &) = delete;
     BasicBlock &operator=(const BasicBlock &) = delete;
+    ~BasicBlock() final;
+    ACCSYS_SLAB_ALLOC(AllocKind::BasicBlock)
 public:
     using InstListType = List<Instruction>;
     using iterator = InstListType::iterator;
@@ -645,13 +761,27 @@ public:
 private:
     InstListType InstList;
     Function *Parent;
-    std::string Name;
+    // Kept in the string pool of the module, as Value::Name.
+    InternedString Name;
+    // Whether the Order of the instructions is ascending. Removing an
+    // instruction keeps it, inserting one in the middle clears it.
+    mutable bool InstOrderValid = true;
+    // Dense number in the parent function, see Function::getNumBlockNumbers.
+    unsigned Number = 0;
+    // The blocks whose terminator branches here, once per edge. Kept up to
+    // date by the terminators as they enter and leave their blocks and
+    // change their successors.
+    std::vector<BasicBlock *> Preds;
 
     InstListType &getInstList() { return InstList; }
     const InstListType &getInstList() const { return InstList; }
 
     BasicBlock(Function *Parent, BasicBlock *InsertBefore);
     void setParent(Function *F);
+    /// Keep the instruction order valid if I was appended, else invalidate it.
+    void instructionInserted(Instruction *I);
+    void addPredecessorEdge(BasicBlock *Pred) { Preds.push_back(Pred); }
+    void removePredecessorEdge(BasicBlock *Pred);
 
     friend class Function;
 public:
@@ -661,11 +791,35 @@ public:
     static BasicBlock *Create(Function *Parent = nullptr, BasicBlock *InsertBefore = nullptr);
     /// Insert an unlinked basic block into a function immediately before the specified basic block.
     void insertInto(Function *Parent, BasicBlock *InsertBefore = nullptr);
+    /// Unlink the basic block from its function, but do not delete it.
+    void removeFromParent();
+    /// Unlink the basic block from its function and delete it with its
+    /// instructions, return the iterator to the next block.
+    List<BasicBlock>::iterator eraseFromParent();
 
     Function *getParent() const { return Parent; }
     bool hasName() const;
     void setName(std::string_view Name);
-    std::string_view getName() const { return Name; }
+    std::string_view getName() const { return Name.str(); }
+
+    /// Move the instructions [First, Last) of FromBB before ToIT in this
+    /// block. The instructions are relinked in constant time, then given
+    /// this block as their parent.
+    void splice(iterator ToIT, BasicBlock *FromBB, iterator First, iterator Last);
+    /// Move all instructions of FromBB before ToIT in this block.
+    void splice(iterator ToIT, BasicBlock *FromBB) {
+        splice(ToIT, FromBB, FromBB->begin(), FromBB->end());
+    }
+
+    /// Return true if the instruction order numbers used by comesBefore are
+    /// up to date, renumberInstructions brings them up to date.
+    bool isInstrOrderValid() const { return InstOrderValid; }
+    void invalidateOrders() { InstOrderValid = false; }
+    void renumberInstructions() const;
+
+    /// Return the dense number of the block in its function, see
+    /// Function::getNumBlockNumbers. Meaningless if it is not in a function.
+    unsigned getNumber() const { return Number; }
     
     /// Returns the terminator instruction if the block is well formed or null
     /// if the block is not well formed.
@@ -679,6 +833,64 @@ public:
             static_cast<const BasicBlock *>(this)->getTerminator()
         );
     }
+
+    /// Iteration over the successors, the successors of the terminator.
+    /// A block without a terminator has none.
+    class succ_iterator {
+        const Instruction *Term;
+        unsigned Idx;
+    public:
+        using value_type = BasicBlock *;
+        using difference_type = std::ptrdiff_t;
+        using pointer = BasicBlock **;
+        using reference = BasicBlock *;
+        using iterator_category = std::forward_iterator_tag;
+
+        succ_iterator(const Instruction *Term, unsigned Idx) : Term(Term), Idx(Idx) {}
+        BasicBlock *operator*() const { return Term->getSuccessor(Idx); }
+        succ_iterator &operator++() {
+            ++Idx;
+            return *this;
+        }
+        succ_iterator operator++(int) {
+            auto Tmp = *this;
+            ++Idx;
+            return Tmp;
+        }
+        bool operator==(const succ_iterator &RHS) const { return Idx == RHS.Idx; }
+        bool operator!=(const succ_iterator &RHS) const { return Idx != RHS.Idx; }
+    };
+    struct SuccessorRange {
+        succ_iterator Begin, End;
+        succ_iterator begin() const { return Begin; }
+        succ_iterator end() const { return End; }
+    };
+    succ_iterator succ_begin() const { return {getTerminator(), 0}; }
+    succ_iterator succ_end() const { return {getTerminator(), getNumSuccessors()}; }
+    SuccessorRange successors() const { return {succ_begin(), succ_end()}; }
+    unsigned getNumSuccessors() const {
+        const Instruction *Term = getTerminator();
+        return Term ? Term->getNumSuccessors() : 0;
+    }
+    BasicBlock *getSuccessor(unsigned i) const { return getTerminator()->getSuccessor(i); }
+    /// Return the successor if there is exactly one.
+    BasicBlock *getSingleSuccessor() const {
+        return getNumSuccessors() == 1 ? getSuccessor(0) : nullptr;
+    }
+
+    /// The predecessors, once for every edge into the block, in no
+    /// particular order. Maintained as the terminators change, so the
+    /// queries are constant time.
+    using pred_iterator = std::vector<BasicBlock *>::const_iterator;
+    pred_iterator pred_begin() const { return Preds.begin(); }
+    pred_iterator pred_end() const { return Preds.end(); }
+    const std::vector<BasicBlock *> &predecessors() const { return Preds; }
+    unsigned getNumPredecessors() const { return Preds.size(); }
+    bool hasNPredecessors(unsigned N) const { return Preds.size() == N; }
+    /// Return the predecessor if there is exactly one edge into the block.
+    BasicBlock *getSinglePredecessor() const {
+        return Preds.size() == 1 ? Preds.front() : nullptr;
+    }
     // container standard interface
     iterator begin() { return InstList.begin(); }
     const_iterator begin() const { return InstList.cbegin(); }
@@ -713,6 +925,9 @@ public:
     Function *getParent() { return Parent; }
     /// Return the argument index in its parent function.
     unsigned getArgNo() const { return ArgNo; }
+    /// Return the dense number of the argument in its function, the
+    /// arguments come first, see Function::getNumValueNumbers.
+    unsigned getNumber() const { return ArgNo; }
 
     static bool classof(const Value *V) {
         return V->getValueID() == Value::ArgumentVal;
@@ -728,6 +943,7 @@ public:
     Function(const Function&) = delete;
     void operator=(const Function&) = delete;
     ~Function() final;
+    ACCSYS_SLAB_ALLOC(AllocKind::Function)
     /// Basic blocks iteration.
     using BasicBlockListType = List<BasicBlock>;
     using iterator = BasicBlockListType::iterator;
@@ -743,11 +959,24 @@ private:
     unsigned NumArgs = 0;
     Argument *Arguments = nullptr;
     bool ExternalLinkage = false;
-    std::string Name;
+    InternedString Name;
     Module *Parent;
+    // Bounds of the value and block numbers, and the numbers given back by
+    // erased objects, reused by the next ones. Declared before the blocks,
+    // which give their numbers back when destroyed.
+    unsigned NumValueNumbers = 0;
+    unsigned NumBlockNumbers = 0;
+    std::vector<unsigned> FreeValueNumbers;
+    std::vector<unsigned> FreeBlockNumbers;
     BasicBlockListType BasicBlockList;
 
     friend class BasicBlock;
+    friend class Instruction;
+
+    unsigned allocateValueNumber();
+    void releaseValueNumber(unsigned Number) { FreeValueNumbers.push_back(Number); }
+    unsigned allocateBlockNumber();
+    void releaseBlockNumber(unsigned Number) { FreeBlockNumbers.push_back(Number); }
 
     // Private accessors to basic blocks and function arguments.
     BasicBlockListType &getBasicBlockList() { return BasicBlockList; }
@@ -759,7 +988,7 @@ public:
     /// Insert BB in the basic block list at Position.
     Function::iterator insert(Function::iterator Position, BasicBlock *BB);
     
-    std::string_view getName() const { return Name; }
+    std::string_view getName() const { return Name.str(); }
     bool hasName() const;
     Module *getParent() const { return Parent; }
     /// Returns the FunctionType.
@@ -805,6 +1034,29 @@ public:
     // Arguments container method.
     [[nodiscard]] std::size_t arg_size() const { return NumArgs; }
     [[nodiscard]] bool arg_empty() const { return arg_size() == 0; }
+
+    /// The arguments and instructions of a function have dense numbers,
+    /// the arguments first, and its basic blocks have dense numbers in
+    /// another space, so an analysis can keep its per value data in flat
+    /// vectors, bit vectors or IndexedMaps indexed by getNumber() instead
+    /// of hash maps. An object gets a number when it enters the function;
+    /// the number of an erased one is reused by the next.
+    /// Return one past the largest value number and block number.
+    unsigned getNumValueNumbers() const { return NumValueNumbers; }
+    unsigned getNumBlockNumbers() const { return NumBlockNumbers; }
+    /// Return the number of an argument or instruction of this function.
+    static unsigned getValueNumber(const Value *V);
+    /// Renumber the values and blocks in order, closing the holes left by
+    /// erased ones. Numbers held by analyses are stale afterwards.
+    void renumberValues();
+};
+
+/// Index functors of IndexedMaps over the values and blocks of a function.
+struct ValueNumberIndex {
+    unsigned operator()(const Value *V) const { return Function::getValueNumber(V); }
+};
+struct BlockNumberIndex {
+    unsigned operator()(const BasicBlock *BB) const { return BB->getNumber(); }
 };
 
 
@@ -819,6 +1071,7 @@ private:
     bool ExternalLinkage;
     Module *Parent;
 public:
+    ACCSYS_SLAB_ALLOC(AllocKind::GlobalVariable)
     static GlobalVariable *Create(Type *EleTy, std::size_t NumElements = 1, bool ExternalLinkage = false,
                                   std::string_view Name = "", Module *M = nullptr);
     /// Return the element type of the global variable.
@@ -850,6 +1103,12 @@ public:
     using const_global_iterator = GlobalListType::const_iterator;
 
 private:
+    // Backs the functions, blocks, instructions and globals created into
+    // this module. Declared first so it is destroyed after all of them.
+    SlabAllocator Allocator;
+    // Names of the values, blocks and functions of this module, which the
+    // symbol tables below refer to.
+    StringPool NamePool;
     std::unordered_map<std::string_view, Function *> SymbolFunctionMap;
     std::unordered_map<std::string_view, GlobalVariable *> SymbolGlobalMap;
     FunctionListType FunctionList;
@@ -860,7 +1119,19 @@ private:
 public:
     /// Implementation of IR dump to a output stream.
     /// if isForDebug is set, the IR writer will print verbose type annotations.
-    void print(std::ostream &OS, bool isForDebug) const;
+    /// The text is formatted into memory first and written to OS at once,
+    /// functions are formatted by up to NumThreads threads.
+    void print(std::ostream &OS, bool isForDebug, unsigned NumThreads = 1) const;
+    /// Same as print, but writes the file at Path with a single write.
+    /// Return false if the file cannot be written.
+    bool printToFile(const std::string &Path, bool isForDebug, unsigned NumThreads = 1) const;
+    /// Return the allocator of the IR objects of this module.
+    /// Objects created into a module must not outlive it.
+    SlabAllocator &getAllocator() { return Allocator; }
+    const SlabAllocator &getAllocator() const { return Allocator; }
+    /// Return the string pool of the names in this module.
+    StringPool &getNamePool() { return NamePool; }
+    const StringPool &getNamePool() const { return NamePool; }
     /// Function accessor.
     /// Look up the specified function in the module symbol table.
     Function *getFunction(std::string_view Name) const;
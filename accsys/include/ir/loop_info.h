@@ -0,0 +1,147 @@
+#pragma once
+
+#include "ir/dominators.h"
+#include "ir/ir.h"
+#include "utils/indexed_map.h"
+#include "utils/sparse_bit_vector.h"
+
+#include <memory>
+#include <vector>
+
+class LoopInfo;
+
+/// \brief Loop is a natural loop: a header block that dominates the
+/// latches, the blocks with a back edge to it, and every block that
+/// reaches a latch without going through the header.
+/// A lowered while statement is a loop headed by its first condition
+/// block, with the body blocks that jump back to it as latches.
+class Loop {
+    Loop *ParentLoop = nullptr;
+    std::vector<Loop *> SubLoops;
+    // The header first, then the other blocks in reverse postorder of the
+    // CFG. Blocks of the subloops are included.
+    std::vector<BasicBlock *> Blocks;
+    // The block numbers of Blocks.
+    SparseBitVector BlockSet;
+
+    friend class LoopInfo;
+
+    explicit Loop(BasicBlock *Header) { addBlockEntry(Header); }
+    void addBlockEntry(BasicBlock *BB) {
+        Blocks.push_back(BB);
+        BlockSet.set(BB->getNumber());
+    }
+public:
+    Loop(const Loop &) = delete;
+    Loop &operator=(const Loop &) = delete;
+
+    using iterator = std::vector<Loop *>::const_iterator;
+    using block_iterator = std::vector<BasicBlock *>::const_iterator;
+
+    BasicBlock *getHeader() const { return Blocks.front(); }
+    Loop *getParentLoop() const { return ParentLoop; }
+    /// Return the nesting depth, 1 for an outermost loop.
+    unsigned getLoopDepth() const {
+        unsigned Depth = 1;
+        for (const Loop *L = ParentLoop; L; L = L->ParentLoop)
+            ++Depth;
+        return Depth;
+    }
+    bool isOutermost() const { return ParentLoop == nullptr; }
+    bool isInnermost() const { return SubLoops.empty(); }
+
+    /// The loops immediately nested in this one, in the order of their
+    /// headers in the CFG.
+    const std::vector<Loop *> &getSubLoops() const { return SubLoops; }
+    iterator begin() const { return SubLoops.begin(); }
+    iterator end() const { return SubLoops.end(); }
+
+    const std::vector<BasicBlock *> &blocks() const { return Blocks; }
+    block_iterator block_begin() const { return Blocks.begin(); }
+    block_iterator block_end() const { return Blocks.end(); }
+    std::size_t getNumBlocks() const { return Blocks.size(); }
+
+    bool contains(const BasicBlock *BB) const { return BlockSet.test(BB->getNumber()); }
+    /// Return true if L is this loop or nested in it.
+    bool contains(const Loop *L) const {
+        for (; L; L = L->ParentLoop)
+            if (L == this)
+                return true;
+        return false;
+    }
+
+    /// Return the blocks of the loop with a back edge to the header.
+    std::vector<BasicBlock *> getLoopLatches() const;
+    /// Return the latch if there is only one, null otherwise.
+    BasicBlock *getLoopLatch() const;
+    /// Return the blocks of the loop with a successor outside of it.
+    std::vector<BasicBlock *> getExitingBlocks() const;
+    /// Return the exiting block if there is only one, null otherwise.
+    BasicBlock *getExitingBlock() const;
+    /// Return the blocks outside of the loop with a predecessor in it, each
+    /// once.
+    std::vector<BasicBlock *> getExitBlocks() const;
+    /// Return the exit block if there is only one, null otherwise.
+    BasicBlock *getExitBlock() const;
+    /// Return the block outside of the loop the header is entered from if
+    /// there is only one, null otherwise.
+    BasicBlock *getLoopPredecessor() const;
+    /// Return the loop predecessor if its only successor is the header, a
+    /// place for code hoisted out of the loop. Null otherwise.
+    BasicBlock *getLoopPreheader() const;
+};
+
+/// \brief LoopInfo is the loop nesting forest of a function: its natural
+/// loops and the innermost loop of every block.
+///
+/// The loops are found on the dominator tree, a back edge being an edge
+/// to a block that dominates its source. Loops with the same header are
+/// one loop with several latches. Blocks not reachable from the entry
+/// block are in no loop.
+/// Like DominanceFrontier, the forest has to be recalculated after the
+/// CFG changes, and after the blocks are renumbered.
+class LoopInfo {
+    std::vector<std::unique_ptr<Loop>> AllLoops;
+    std::vector<Loop *> TopLevelLoops;
+    // The innermost loop of every block, null if it is in none.
+    IndexedMap<Loop *, BlockNumberIndex> BBMap;
+    const Function *Parent = nullptr;
+
+    void discoverAndMapSubloop(Loop *L, std::vector<BasicBlock *> &Backedges,
+                               const DominatorTree &DT);
+public:
+    using iterator = std::vector<Loop *>::const_iterator;
+
+    LoopInfo() = default;
+    explicit LoopInfo(const DominatorTree &DT) { analyze(DT); }
+    LoopInfo(const LoopInfo &) = delete;
+    LoopInfo &operator=(const LoopInfo &) = delete;
+
+    /// Build the forest from the dominator tree of a function, which must
+    /// be up to date.
+    void analyze(const DominatorTree &DT);
+    void releaseMemory();
+
+    /// The outermost loops, in the order of their headers in the CFG.
+    const std::vector<Loop *> &getTopLevelLoops() const { return TopLevelLoops; }
+    iterator begin() const { return TopLevelLoops.begin(); }
+    iterator end() const { return TopLevelLoops.end(); }
+    bool empty() const { return TopLevelLoops.empty(); }
+    /// Return every loop, each before the loops nested in it.
+    std::vector<Loop *> getLoopsInPreorder() const;
+
+    /// Return the innermost loop BB is in, null if it is in none.
+    Loop *getLoopFor(const BasicBlock *BB) const {
+        return BB->getParent() == Parent && BBMap.inBounds(BB) ? BBMap[BB] : nullptr;
+    }
+    Loop *operator[](const BasicBlock *BB) const { return getLoopFor(BB); }
+    /// Return the number of loops BB is in, 0 if it is in none.
+    unsigned getLoopDepth(const BasicBlock *BB) const {
+        const Loop *L = getLoopFor(BB);
+        return L ? L->getLoopDepth() : 0;
+    }
+    bool isLoopHeader(const BasicBlock *BB) const {
+        const Loop *L = getLoopFor(BB);
+        return L && L->getHeader() == BB;
+    }
+};
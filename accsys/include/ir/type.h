@@ -1,17 +1,21 @@
 #pragma once
 
+#include "utils/alloc_stats.h"
 
+#include <cstddef>
+#include <functional>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
 
+class Type;
 class PointerType;
 class FunctionType;
 
 /// Buffer class mamanges the memory of the derived types.
 /// It serves as a type context in single threaded environment.
-template <typename KeyTy, typename V>
+template <typename KeyTy, typename V, typename Hash = std::hash<KeyTy>>
 class Buffer {
 public:
     Buffer() = default;
@@ -19,18 +23,35 @@ public:
         for (auto &[Key, Val]: buffer) {
             Val->~V();
             std::allocator<V>().deallocate(Val, 1);
+            AllocStats::deallocate(AllocKind::Type, sizeof(V));
         }
     }
 protected:
-    using BufferType = std::unordered_map<KeyTy, V *>;
+    using BufferType = std::unordered_map<KeyTy, V *, Hash>;
     BufferType buffer;
 public:
     using iterator = typename BufferType::iterator;
+    /// Return the value of Key, or null if there is none.
+    V *lookup(const KeyTy &Key) const {
+        auto IT = buffer.find(Key);
+        return IT != buffer.end() ? IT->second : nullptr;
+    }
+    /// Allocate the storage of a value to be constructed by the caller
+    /// and then added with insert.
+    V *allocate() {
+        AllocStats::allocate(AllocKind::Type, sizeof(V));
+        return std::allocator<V>().allocate(1);
+    }
+    /// Add a value from allocate under a key that is not in the buffer.
+    void insert(const KeyTy &Key, V *Val) {
+        buffer.emplace(Key, Val);
+    }
     std::pair<iterator, bool> insert_as(const KeyTy &Key) {
         V *DT = nullptr;
         auto Insertion = buffer.insert(std::make_pair(Key, nullptr));
         if (Insertion.second) {
             DT = std::allocator<V>().allocate(1);
+            AllocStats::allocate(AllocKind::Type, sizeof(V));
             Insertion.first->second = DT;
         } else {
             DT = Insertion.first->second;
@@ -39,6 +60,37 @@ public:
     }
 };
 
+/// Structural key of a function type, a view over its return type and
+/// parameter types. A lookup keys a view of the caller's parameters, so
+/// finding an existing type allocates nothing, while the stored keys view
+/// the parameters of the types they map to.
+struct FunctionTypeKey {
+    Type *Result;
+    Type *const *Params;
+    std::size_t NumParams;
+
+    FunctionTypeKey(Type *Result, const std::vector<Type *> &Params)
+        : Result(Result), Params(Params.data()), NumParams(Params.size()) {}
+
+    bool operator==(const FunctionTypeKey &RHS) const {
+        if (Result != RHS.Result || NumParams != RHS.NumParams)
+            return false;
+        for (std::size_t i = 0; i < NumParams; ++i)
+            if (Params[i] != RHS.Params[i])
+                return false;
+        return true;
+    }
+
+    struct Hash {
+        std::size_t operator()(const FunctionTypeKey &Key) const {
+            std::size_t H = std::hash<Type *>()(Key.Result);
+            for (std::size_t i = 0; i < Key.NumParams; ++i)
+                H ^= std::hash<Type *>()(Key.Params[i]) + 0x9e3779b9 + (H << 6) + (H >> 2);
+            return H;
+        }
+    };
+};
+
 /// Type represents the primitive type of Accipit IR and
 /// common interfaces
 class Type {
@@ -58,12 +110,9 @@ protected:
     TypeID ID;
 
     static Type IntegerTy, UnitTy;
-    /// FIXME: `FunctionType` should be cached in the context. This
-    /// is just a naive implementation. C++ 17 does not support transparant 
-    /// key search for hash set. We have to contruct a temporary function
-    /// type is this case, which is not intended.
-    static thread_local unsigned FunctionTypeHandle;
-    static thread_local Buffer<unsigned, FunctionType> FunctionTypes;
+    /// Derived types are uniqued, so two types are equal if and only if
+    /// they are the same object.
+    static thread_local Buffer<FunctionTypeKey, FunctionType, FunctionTypeKey::Hash> FunctionTypes;
     static thread_local Buffer<Type *, PointerType> PointerTypes;
 
     // Type context should be handled by context.
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+/// Kinds of IR memory accounted by AllocStats.
+enum class AllocKind : unsigned {
+    Instruction,
+    Use,
+    Argument,
+    ConstantInt,
+    ConstantUnit,
+    BasicBlock,
+    Function,
+    GlobalVariable,
+    Type,
+    Name,
+    NumKinds
+};
+
+/// Live bytes and object count of one kind.
+struct AllocCounter {
+    std::size_t Bytes = 0;
+    std::size_t Objects = 0;
+};
+
+/// Live memory of the IR by object kind. The counted classes update it
+/// from their operator new/delete, operand and argument arrays from the
+/// constructor of their owner. Like the type context, it is meant for a
+/// single threaded environment.
+class AllocStats {
+    static AllocCounter Counters[static_cast<unsigned>(AllocKind::NumKinds)];
+
+public:
+    static void allocate(AllocKind K, std::size_t Bytes, std::size_t N = 1) {
+        AllocCounter &C = Counters[static_cast<unsigned>(K)];
+        C.Bytes += Bytes;
+        C.Objects += N;
+    }
+    static void deallocate(AllocKind K, std::size_t Bytes, std::size_t N = 1) {
+        AllocCounter &C = Counters[static_cast<unsigned>(K)];
+        C.Bytes -= Bytes;
+        C.Objects -= N;
+    }
+    static const AllocCounter &get(AllocKind K) {
+        return Counters[static_cast<unsigned>(K)];
+    }
+    static const char *getKindName(AllocKind K);
+};
+
+/// Counting operator new/delete for a class whose objects are of kind K.
+/// The sized delete sees the size of the dynamic type, so one use in a
+/// base class with a virtual destructor covers all derived classes.
+#define ACCSYS_COUNTED_ALLOC(K)                                               \
+    static void *operator new(std::size_t Size) {                             \
+        AllocStats::allocate(K, Size);                                        \
+        return ::operator new(Size);                                          \
+    }                                                                         \
+    static void operator delete(void *Ptr, std::size_t Size) {                \
+        AllocStats::deallocate(K, Size);                                      \
+        ::operator delete(Ptr);                                               \
+    }
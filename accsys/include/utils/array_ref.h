@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <vector>
+
+/// \brief ArrayRef is a constant view of a contiguous array of T, in the
+/// spirit of C++20 std::span. It does not own the elements, so it is
+/// cheap to pass by value and is meant for parameters, where it accepts
+/// a std::vector, a std::array, a braced list or a pointer and a size
+/// without building a temporary container.
+/// An ArrayRef to a braced list is only valid until the end of the full
+/// expression, do not store it.
+template <typename T>
+class ArrayRef {
+public:
+    using value_type = T;
+    using iterator = const T *;
+    using const_iterator = const T *;
+    using size_type = std::size_t;
+
+private:
+    const T *Data = nullptr;
+    size_type Length = 0;
+
+public:
+    ArrayRef() = default;
+    ArrayRef(const T &OneElt) : Data(&OneElt), Length(1) {}
+    ArrayRef(const T *Data, size_type Length) : Data(Data), Length(Length) {}
+    ArrayRef(const std::vector<T> &Vec) : Data(Vec.data()), Length(Vec.size()) {}
+    template <std::size_t N>
+    ArrayRef(const std::array<T, N> &Arr) : Data(Arr.data()), Length(N) {}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winit-list-lifetime"
+#endif
+    ArrayRef(const std::initializer_list<T> &List)
+        : Data(List.begin() == List.end() ? nullptr : List.begin()), Length(List.size()) {}
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+    iterator begin() const { return Data; }
+    iterator end() const { return Data + Length; }
+    const T *data() const { return Data; }
+    size_type size() const { return Length; }
+    bool empty() const { return Length == 0; }
+
+    const T &operator[](size_type Index) const {
+        assert(Index < Length && "ArrayRef index out of range!");
+        return Data[Index];
+    }
+    const T &front() const { return (*this)[0]; }
+    const T &back() const { return (*this)[Length - 1]; }
+
+    std::vector<T> vec() const { return std::vector<T>(begin(), end()); }
+};
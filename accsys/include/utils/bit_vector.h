@@ -0,0 +1,196 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+/// \brief BitVector is a dynamically sized set of bits, packed in 64 bit
+/// words. It is the set type for dense domains, such as the value and
+/// block numbers of a function, where dataflow analyses combine whole
+/// sets a word at a time.
+/// Binary operations accept vectors of different sizes, the missing bits
+/// of the shorter one are zero.
+class BitVector {
+    using WordType = std::uint64_t;
+    static constexpr unsigned BitsPerWord = 64;
+
+    std::vector<WordType> Words;
+    unsigned Size = 0;
+
+    static unsigned numWords(unsigned NumBits) {
+        return (NumBits + BitsPerWord - 1) / BitsPerWord;
+    }
+    // Keep the bits past Size zero, count and find rely on it.
+    void clearUnusedBits() {
+        if (unsigned Extra = Size % BitsPerWord)
+            Words.back() &= (WordType(1) << Extra) - 1;
+    }
+
+public:
+    BitVector() = default;
+    explicit BitVector(unsigned Size, bool Value = false)
+        : Words(numWords(Size), Value ? ~WordType(0) : 0), Size(Size) {
+        clearUnusedBits();
+    }
+
+    /// Return the number of bits, set or not.
+    unsigned size() const { return Size; }
+    bool empty() const { return Size == 0; }
+
+    /// Grow or shrink to N bits, the new bits are Value.
+    void resize(unsigned N, bool Value = false) {
+        unsigned OldSize = Size;
+        Words.resize(numWords(N), Value ? ~WordType(0) : 0);
+        Size = N;
+        if (Value && N > OldSize && OldSize % BitsPerWord) {
+            // the tail of the old last word
+            Words[OldSize / BitsPerWord] |= ~WordType(0) << (OldSize % BitsPerWord);
+        }
+        clearUnusedBits();
+    }
+    void clear() {
+        Words.clear();
+        Size = 0;
+    }
+
+    bool test(unsigned Idx) const {
+        assert(Idx < Size && "Bit index out of range!");
+        return (Words[Idx / BitsPerWord] >> (Idx % BitsPerWord)) & 1;
+    }
+    bool operator[](unsigned Idx) const { return test(Idx); }
+
+    BitVector &set() {
+        std::fill(Words.begin(), Words.end(), ~WordType(0));
+        clearUnusedBits();
+        return *this;
+    }
+    BitVector &set(unsigned Idx) {
+        assert(Idx < Size && "Bit index out of range!");
+        Words[Idx / BitsPerWord] |= WordType(1) << (Idx % BitsPerWord);
+        return *this;
+    }
+    BitVector &reset() {
+        std::fill(Words.begin(), Words.end(), 0);
+        return *this;
+    }
+    BitVector &reset(unsigned Idx) {
+        assert(Idx < Size && "Bit index out of range!");
+        Words[Idx / BitsPerWord] &= ~(WordType(1) << (Idx % BitsPerWord));
+        return *this;
+    }
+    /// Return the old value of bit Idx and set it.
+    bool test_and_set(unsigned Idx) {
+        bool Old = test(Idx);
+        set(Idx);
+        return Old;
+    }
+
+    /// Return the number of set bits.
+    unsigned count() const {
+        unsigned N = 0;
+        for (WordType W : Words)
+            N += __builtin_popcountll(W);
+        return N;
+    }
+    bool any() const {
+        return std::any_of(Words.begin(), Words.end(), [](WordType W) { return W != 0; });
+    }
+    bool none() const { return !any(); }
+
+    /// Return the index of the first set bit, or -1 if there is none.
+    int find_first() const { return find_from(0); }
+    /// Return the index of the first set bit after Prev, or -1.
+    int find_next(unsigned Prev) const { return find_from(Prev + 1); }
+
+    /// Union, intersection and difference with RHS.
+    BitVector &operator|=(const BitVector &RHS) {
+        if (RHS.Size > Size)
+            resize(RHS.Size);
+        for (std::size_t i = 0, e = RHS.Words.size(); i != e; ++i)
+            Words[i] |= RHS.Words[i];
+        return *this;
+    }
+    BitVector &operator&=(const BitVector &RHS) {
+        std::size_t Common = std::min(Words.size(), RHS.Words.size());
+        for (std::size_t i = 0; i != Common; ++i)
+            Words[i] &= RHS.Words[i];
+        std::fill(Words.begin() + Common, Words.end(), 0);
+        return *this;
+    }
+    /// Clear the bits set in RHS, this &= ~RHS.
+    BitVector &reset(const BitVector &RHS) {
+        std::size_t Common = std::min(Words.size(), RHS.Words.size());
+        for (std::size_t i = 0; i != Common; ++i)
+            Words[i] &= ~RHS.Words[i];
+        return *this;
+    }
+    /// Return true if this and RHS have a set bit in common.
+    bool anyCommon(const BitVector &RHS) const {
+        std::size_t Common = std::min(Words.size(), RHS.Words.size());
+        for (std::size_t i = 0; i != Common; ++i)
+            if (Words[i] & RHS.Words[i])
+                return true;
+        return false;
+    }
+
+    /// Equal if the same bits are set, whatever the sizes.
+    bool operator==(const BitVector &RHS) const {
+        std::size_t Common = std::min(Words.size(), RHS.Words.size());
+        if (!std::equal(Words.begin(), Words.begin() + Common, RHS.Words.begin()))
+            return false;
+        const auto &Longer = Words.size() > RHS.Words.size() ? Words : RHS.Words;
+        return std::all_of(Longer.begin() + Common, Longer.end(), [](WordType W) { return W == 0; });
+    }
+    bool operator!=(const BitVector &RHS) const { return !(*this == RHS); }
+
+    /// Iteration over the indices of the set bits.
+    class const_set_bits_iterator {
+        const BitVector *Parent;
+        int Current;
+    public:
+        using value_type = unsigned;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const unsigned *;
+        using reference = unsigned;
+        using iterator_category = std::forward_iterator_tag;
+
+        const_set_bits_iterator(const BitVector *Parent, int Current)
+            : Parent(Parent), Current(Current) {}
+        unsigned operator*() const { return Current; }
+        const_set_bits_iterator &operator++() {
+            Current = Parent->find_next(Current);
+            return *this;
+        }
+        const_set_bits_iterator operator++(int) {
+            auto Tmp = *this;
+            ++*this;
+            return Tmp;
+        }
+        bool operator==(const const_set_bits_iterator &RHS) const { return Current == RHS.Current; }
+        bool operator!=(const const_set_bits_iterator &RHS) const { return Current != RHS.Current; }
+    };
+    struct SetBitsView {
+        const BitVector *Parent;
+        const_set_bits_iterator begin() const { return {Parent, Parent->find_first()}; }
+        const_set_bits_iterator end() const { return {Parent, -1}; }
+    };
+    SetBitsView set_bits() const { return SetBitsView {this}; }
+
+private:
+    int find_from(unsigned Idx) const {
+        if (Idx >= Size)
+            return -1;
+        std::size_t WordIdx = Idx / BitsPerWord;
+        WordType W = Words[WordIdx] & (~WordType(0) << (Idx % BitsPerWord));
+        while (true) {
+            if (W)
+                return WordIdx * BitsPerWord + __builtin_ctzll(W);
+            if (++WordIdx == Words.size())
+                return -1;
+            W = Words[WordIdx];
+        }
+    }
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+/// Index functor of an IndexedMap keyed by the indices themselves.
+struct IdentityIndex {
+    unsigned operator()(unsigned Index) const { return Index; }
+};
+
+/// \brief IndexedMap is a map from keys with a dense index, such as the
+/// values and blocks of a function by their numbers, to T, stored in a
+/// flat vector. ToIndexT turns a key into its index. Entries not written
+/// yet read as the null value given to the constructor.
+/// The map does not grow on access, call grow with the largest index
+/// first, e.g. Function::getNumValueNumbers() - 1.
+template <typename T, typename ToIndexT = IdentityIndex>
+class IndexedMap {
+    std::vector<T> Storage;
+    T NullVal = T();
+    ToIndexT ToIndex;
+
+public:
+    using reference = typename std::vector<T>::reference;
+    using const_reference = typename std::vector<T>::const_reference;
+
+    IndexedMap() = default;
+    explicit IndexedMap(const T &NullVal) : NullVal(NullVal) {}
+
+    template <typename KeyT>
+    reference operator[](const KeyT &Key) {
+        assert(ToIndex(Key) < Storage.size() && "Index out of bounds!");
+        return Storage[ToIndex(Key)];
+    }
+    template <typename KeyT>
+    const_reference operator[](const KeyT &Key) const {
+        assert(ToIndex(Key) < Storage.size() && "Index out of bounds!");
+        return Storage[ToIndex(Key)];
+    }
+    template <typename KeyT>
+    bool inBounds(const KeyT &Key) const { return ToIndex(Key) < Storage.size(); }
+
+    /// Make index N valid, new entries are the null value.
+    void grow(std::size_t N) {
+        if (N >= Storage.size())
+            Storage.resize(N + 1, NullVal);
+    }
+    /// Reset every entry to the null value.
+    void reset() { Storage.assign(Storage.size(), NullVal); }
+    void clear() { Storage.clear(); }
+    std::size_t size() const { return Storage.size(); }
+};
@@ -138,6 +138,24 @@ protected:
         Node.Prev = Node.Next = nullptr;
     }
 
+    /// Move the nodes [First, Last) before where, which must not be
+    /// in the range. Only the ends of the range are relinked.
+    static void transfer(iterator where, iterator First, iterator Last) {
+        if (First == Last || where == Last)
+            return;
+        ListNode *FirstNode = First.getNodePtr();
+        ListNode *EndNode = Last.getNodePtr();
+        ListNode *LastNode = EndNode->Prev;
+        // unlink the range.
+        FirstNode->Prev->Next = EndNode;
+        EndNode->Prev = FirstNode->Prev;
+        // link it before where.
+        ListNode *WhereNode = where.getNodePtr();
+        WhereNode->Prev->Next = FirstNode;
+        FirstNode->Prev = WhereNode->Prev;
+        LastNode->Next = WhereNode;
+        WhereNode->Prev = LastNode;
+    }
 };
 
 /// An intrusive double linked list with ownership.
@@ -161,6 +179,8 @@ public:
 
 protected:
     ListNode<T> Sentinel;
+    // Cached number of nodes, kept by every insertion and removal.
+    size_type NumNodes = 0;
 
     void resetSentinel() {
         Sentinel.Next = Sentinel.Prev = &Sentinel;
@@ -186,15 +206,10 @@ public:
         return const_reverse_iterator(&Sentinel);
     }
 
-    /// Calculate the size in linear time.
-    [[nodiscard]] size_type size() const {
-        return std::distance(cbegin(), cend());
-    }
+    /// Return the size in constant time.
+    [[nodiscard]] size_type size() const { return NumNodes; }
 
-    [[nodiscard]] bool empty() const {
-        return Sentinel.getNextNode() == &Sentinel &&
-               Sentinel.getPrevNode() == &Sentinel;
-    }
+    [[nodiscard]] bool empty() const { return NumNodes == 0; }
 
 
     reference front() { return *begin(); }
@@ -203,6 +218,8 @@ public:
     const_reference back() const { return *crbegin(); }
 
     iterator insert(iterator pos, pointer New) {
+        if (New)
+            ++NumNodes;
         return ListNode<T>::insert(pos, New);
     }
 
@@ -217,6 +234,7 @@ public:
     pointer remove(iterator &IT) {
         pointer Node = &*IT++;
         ListNode<T>::remove(*Node);
+        --NumNodes;
         return Node;
     }
 
@@ -265,4 +283,36 @@ public:
     }
     
     void clear() { erase(begin(), end()); }
+
+    /// Move the nodes [First, Last) of Other before pos.
+    /// The nodes are relinked in constant time. Moving a part of another
+    /// list counts the moved nodes to keep both sizes, moving all of it
+    /// or within a list does not.
+    void splice(iterator pos, List &Other, iterator First, iterator Last) {
+        if (&Other == this || First == Last) {
+            ListNode<T>::transfer(pos, First, Last);
+            return;
+        }
+        size_type N = (First == Other.begin() && Last == Other.end())
+                          ? Other.NumNodes
+                          : std::distance(First, Last);
+        splice(pos, Other, First, Last, N);
+    }
+    /// Same as above, for a caller that already knows there are N nodes
+    /// in [First, Last).
+    void splice(iterator pos, List &Other, iterator First, iterator Last, size_type N) {
+        assert(N <= Other.NumNodes && "Range larger than the list!");
+        Other.NumNodes -= N;
+        NumNodes += N;
+        ListNode<T>::transfer(pos, First, Last);
+    }
+    /// Move the node N of Other before pos.
+    void splice(iterator pos, List &Other, iterator N) {
+        iterator Last = N;
+        splice(pos, Other, N, ++Last);
+    }
+    /// Move all nodes of Other before pos.
+    void splice(iterator pos, List &Other) {
+        splice(pos, Other, Other.begin(), Other.end());
+    }
 };
\ No newline at end of file
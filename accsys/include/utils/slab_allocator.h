@@ -0,0 +1,91 @@
+#pragma once
+
+#include "utils/alloc_stats.h"
+
+#include <cstddef>
+#include <vector>
+
+/// \brief Slab allocator backing the IR objects of one Module.
+/// Memory is bumped out of slabs that only go back to the system when
+/// the allocator is destroyed, so tearing down a module is a handful of
+/// frees. Blocks given back by deallocate are kept in free lists by size
+/// class and reused by later allocations of the same size, which keeps
+/// 'eraseFromParent' heavy passes from growing the module.
+/// Like the type context, it is meant for a single threaded environment.
+class SlabAllocator {
+public:
+    SlabAllocator() = default;
+    SlabAllocator(const SlabAllocator &) = delete;
+    SlabAllocator &operator=(const SlabAllocator &) = delete;
+    ~SlabAllocator();
+
+    /// Blocks are aligned to this, enough for every IR class.
+    static constexpr std::size_t Alignment = alignof(void *);
+    /// Larger blocks are not worth keeping in a free list, they are
+    /// taken from the global heap by allocateOwned.
+    static constexpr std::size_t MaxBlockSize = 1024;
+
+    /// Allocate Size (<= MaxBlockSize) bytes.
+    void *allocate(std::size_t Size);
+    /// Give back a block of Size bytes returned by allocate.
+    void deallocate(void *Ptr, std::size_t Size);
+
+    /// Return the number of slabs and the bytes they hold.
+    std::size_t getNumSlabs() const { return Slabs.size(); }
+    std::size_t getTotalMemory() const { return TotalMemory; }
+
+    /// Bytes in front of a block of allocateOwned recording its owner.
+    static constexpr std::size_t OwnerSize = sizeof(SlabAllocator *);
+
+    /// Allocate Size bytes owned by A, or by the global heap if A is null
+    /// or the block is too large. The owner is recorded in front of the
+    /// block, so deallocateOwned and getOwner need nothing but the pointer.
+    /// Prefix more bytes are reserved in front of the owner for the caller,
+    /// as the operands of an instruction.
+    static void *allocateOwned(SlabAllocator *A, std::size_t Size, std::size_t Prefix = 0);
+    /// Free a block returned by allocateOwned with the same Size and Prefix.
+    static void deallocateOwned(void *Ptr, std::size_t Size, std::size_t Prefix = 0);
+    /// Return the allocator owning a block returned by allocateOwned,
+    /// null for the global heap.
+    static SlabAllocator *getOwner(const void *Ptr) {
+        return *(static_cast<SlabAllocator *const *>(Ptr) - 1);
+    }
+
+private:
+    static constexpr std::size_t NumSizeClasses = MaxBlockSize / Alignment;
+    static constexpr std::size_t InitialSlabSize = 16 * 1024;
+
+    struct FreeBlock {
+        FreeBlock *Next;
+    };
+
+    char *CurPtr = nullptr;
+    char *End = nullptr;
+    std::size_t TotalMemory = 0;
+    std::vector<void *> Slabs;
+    FreeBlock *FreeLists[NumSizeClasses] = {};
+
+    static std::size_t getSizeClass(std::size_t Size) {
+        return (Size + Alignment - 1) / Alignment - 1;
+    }
+    void startNewSlab(std::size_t MinSize);
+};
+
+/// Counting operator new/delete for a class whose objects are of kind K
+/// and live in the slabs of their module. 'new (A) T(...)' places the
+/// object in allocator A, plain 'new' and a null A on the global heap.
+/// Deleting works the same either way, so detached objects can still be
+/// deleted by hand. The class must be aligned to at most
+/// SlabAllocator::Alignment.
+#define ACCSYS_SLAB_ALLOC(K)                                                  \
+    static void *operator new(std::size_t Size, SlabAllocator *A) {           \
+        AllocStats::allocate(K, Size);                                        \
+        return SlabAllocator::allocateOwned(A, Size);                         \
+    }                                                                         \
+    static void *operator new(std::size_t Size) {                             \
+        return operator new(Size, static_cast<SlabAllocator *>(nullptr));     \
+    }                                                                         \
+    static void operator delete(void *Ptr, std::size_t Size) {                \
+        AllocStats::deallocate(K, Size);                                      \
+        SlabAllocator::deallocateOwned(Ptr, Size);                            \
+    }
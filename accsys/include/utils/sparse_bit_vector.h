@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+/// \brief SparseBitVector is a set of unsigned integers stored as a
+/// sorted array of 128 bit elements, only the elements with a set bit
+/// are kept. It suits sets that are small compared with their universe,
+/// such as the live values of a block among all values of a function,
+/// where a BitVector would spend most of its time on zero words.
+/// The set operations return whether this set changed, which is what a
+/// dataflow solver iterates on.
+class SparseBitVector {
+    using WordType = std::uint64_t;
+    static constexpr unsigned BitsPerWord = 64;
+    static constexpr unsigned WordsPerElement = 2;
+    static constexpr unsigned ElementSize = BitsPerWord * WordsPerElement;
+
+    struct Element {
+        unsigned Index;
+        WordType Words[WordsPerElement] = {};
+
+        explicit Element(unsigned Index) : Index(Index) {}
+        bool empty() const {
+            return std::all_of(std::begin(Words), std::end(Words), [](WordType W) { return W == 0; });
+        }
+        bool operator==(const Element &RHS) const {
+            return Index == RHS.Index && std::equal(std::begin(Words), std::end(Words), RHS.Words);
+        }
+        bool operator!=(const Element &RHS) const { return !(*this == RHS); }
+    };
+
+    // Sorted by Index, none of them empty.
+    std::vector<Element> Elements;
+
+    std::vector<Element>::iterator lowerBound(unsigned Index) {
+        return std::lower_bound(Elements.begin(), Elements.end(), Index,
+                                [](const Element &E, unsigned Idx) { return E.Index < Idx; });
+    }
+    std::vector<Element>::const_iterator lowerBound(unsigned Index) const {
+        return const_cast<SparseBitVector *>(this)->lowerBound(Index);
+    }
+
+public:
+    bool test(unsigned Idx) const {
+        auto IT = lowerBound(Idx / ElementSize);
+        if (IT == Elements.end() || IT->Index != Idx / ElementSize)
+            return false;
+        unsigned Bit = Idx % ElementSize;
+        return (IT->Words[Bit / BitsPerWord] >> (Bit % BitsPerWord)) & 1;
+    }
+    void set(unsigned Idx) {
+        auto IT = lowerBound(Idx / ElementSize);
+        if (IT == Elements.end() || IT->Index != Idx / ElementSize)
+            IT = Elements.insert(IT, Element(Idx / ElementSize));
+        unsigned Bit = Idx % ElementSize;
+        IT->Words[Bit / BitsPerWord] |= WordType(1) << (Bit % BitsPerWord);
+    }
+    void reset(unsigned Idx) {
+        auto IT = lowerBound(Idx / ElementSize);
+        if (IT == Elements.end() || IT->Index != Idx / ElementSize)
+            return;
+        unsigned Bit = Idx % ElementSize;
+        IT->Words[Bit / BitsPerWord] &= ~(WordType(1) << (Bit % BitsPerWord));
+        if (IT->empty())
+            Elements.erase(IT);
+    }
+    /// Return the old value of bit Idx and set it.
+    bool test_and_set(unsigned Idx) {
+        if (test(Idx))
+            return true;
+        set(Idx);
+        return false;
+    }
+
+    void clear() { Elements.clear(); }
+    bool empty() const { return Elements.empty(); }
+    /// Return the number of set bits.
+    unsigned count() const {
+        unsigned N = 0;
+        for (const Element &E : Elements)
+            for (WordType W : E.Words)
+                N += __builtin_popcountll(W);
+        return N;
+    }
+
+    /// Return the smallest set bit, or -1 if the set is empty.
+    int find_first() const {
+        if (Elements.empty())
+            return -1;
+        const Element &E = Elements.front();
+        for (unsigned i = 0; i != WordsPerElement; ++i)
+            if (E.Words[i])
+                return E.Index * ElementSize + i * BitsPerWord + __builtin_ctzll(E.Words[i]);
+        assert(false && "Empty element in a SparseBitVector!");
+        return -1;
+    }
+
+    /// Union with RHS, return true if this changed.
+    bool operator|=(const SparseBitVector &RHS) {
+        if (this == &RHS || RHS.empty())
+            return false;
+        std::vector<Element> Result;
+        Result.reserve(Elements.size() + RHS.Elements.size());
+        bool Changed = false;
+        auto LI = Elements.begin(), LE = Elements.end();
+        auto RI = RHS.Elements.begin(), RE = RHS.Elements.end();
+        while (LI != LE || RI != RE) {
+            if (RI == RE || (LI != LE && LI->Index < RI->Index)) {
+                Result.push_back(*LI++);
+            } else if (LI == LE || RI->Index < LI->Index) {
+                Result.push_back(*RI++);
+                Changed = true;
+            } else {
+                Element E = *LI++;
+                for (unsigned i = 0; i != WordsPerElement; ++i) {
+                    WordType Merged = E.Words[i] | RI->Words[i];
+                    Changed |= Merged != E.Words[i];
+                    E.Words[i] = Merged;
+                }
+                Result.push_back(E);
+                ++RI;
+            }
+        }
+        if (Changed)
+            Elements = std::move(Result);
+        return Changed;
+    }
+    /// Intersection with RHS, return true if this changed.
+    bool operator&=(const SparseBitVector &RHS) {
+        if (this == &RHS)
+            return false;
+        return filter(RHS, false);
+    }
+    /// Remove the bits set in RHS, this &= ~RHS, return true if this changed.
+    bool intersectWithComplement(const SparseBitVector &RHS) {
+        if (this == &RHS) {
+            bool Changed = !empty();
+            clear();
+            return Changed;
+        }
+        return filter(RHS, true);
+    }
+    /// Return true if this and RHS have a set bit in common.
+    bool intersects(const SparseBitVector &RHS) const {
+        auto LI = Elements.begin(), LE = Elements.end();
+        auto RI = RHS.Elements.begin(), RE = RHS.Elements.end();
+        while (LI != LE && RI != RE) {
+            if (LI->Index < RI->Index) {
+                ++LI;
+            } else if (RI->Index < LI->Index) {
+                ++RI;
+            } else {
+                for (unsigned i = 0; i != WordsPerElement; ++i)
+                    if (LI->Words[i] & RI->Words[i])
+                        return true;
+                ++LI, ++RI;
+            }
+        }
+        return false;
+    }
+
+    bool operator==(const SparseBitVector &RHS) const { return Elements == RHS.Elements; }
+    bool operator!=(const SparseBitVector &RHS) const { return !(*this == RHS); }
+
+    /// Iteration over the set bits in ascending order.
+    class iterator {
+        const SparseBitVector *Parent;
+        std::size_t ElementIdx;
+        unsigned Bit;
+
+        // Move to the first set bit at or after the current position.
+        void advance() {
+            const auto &Elements = Parent->Elements;
+            for (; ElementIdx != Elements.size(); ++ElementIdx, Bit = 0) {
+                const Element &E = Elements[ElementIdx];
+                for (unsigned i = Bit / BitsPerWord; i != WordsPerElement; ++i) {
+                    WordType W = E.Words[i];
+                    if (i == Bit / BitsPerWord)
+                        W &= ~WordType(0) << (Bit % BitsPerWord);
+                    if (W) {
+                        Bit = i * BitsPerWord + __builtin_ctzll(W);
+                        return;
+                    }
+                }
+            }
+            Bit = 0;
+        }
+    public:
+        using value_type = unsigned;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const unsigned *;
+        using reference = unsigned;
+        using iterator_category = std::forward_iterator_tag;
+
+        iterator(const SparseBitVector *Parent, std::size_t ElementIdx)
+            : Parent(Parent), ElementIdx(ElementIdx), Bit(0) {
+            advance();
+        }
+        unsigned operator*() const {
+            return Parent->Elements[ElementIdx].Index * ElementSize + Bit;
+        }
+        iterator &operator++() {
+            if (++Bit == ElementSize) {
+                ++ElementIdx;
+                Bit = 0;
+            }
+            advance();
+            return *this;
+        }
+        iterator operator++(int) {
+            auto Tmp = *this;
+            ++*this;
+            return Tmp;
+        }
+        bool operator==(const iterator &RHS) const {
+            return ElementIdx == RHS.ElementIdx && Bit == RHS.Bit;
+        }
+        bool operator!=(const iterator &RHS) const { return !(*this == RHS); }
+    };
+    iterator begin() const { return iterator(this, 0); }
+    iterator end() const { return iterator(this, Elements.size()); }
+
+private:
+    // Keep the bits that are (Complement false) or are not (true) in RHS.
+    bool filter(const SparseBitVector &RHS, bool Complement) {
+        bool Changed = false;
+        auto RI = RHS.Elements.begin(), RE = RHS.Elements.end();
+        auto Out = Elements.begin();
+        for (auto LI = Elements.begin(), LE = Elements.end(); LI != LE; ++LI) {
+            while (RI != RE && RI->Index < LI->Index)
+                ++RI;
+            Element E = *LI;
+            bool Match = RI != RE && RI->Index == LI->Index;
+            for (unsigned i = 0; i != WordsPerElement; ++i) {
+                WordType Mask = Match ? RI->Words[i] : 0;
+                E.Words[i] &= Complement ? ~Mask : Mask;
+            }
+            if (E != *LI)
+                Changed = true;
+            if (!E.empty())
+                *Out++ = E;
+        }
+        Elements.erase(Out, Elements.end());
+        return Changed;
+    }
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+/// Handle of a string interned in a StringPool, a single pointer that is
+/// null for the empty string. It is valid as long as its pool.
+class InternedString {
+    // Points at the characters, the length is stored right in front of them.
+    const char *Data = nullptr;
+
+    explicit InternedString(const char *Data) : Data(Data) {}
+    friend class StringPool;
+public:
+    InternedString() = default;
+
+    bool empty() const { return !Data; }
+    std::string_view str() const {
+        if (!Data)
+            return {};
+        std::uint32_t Length;
+        std::memcpy(&Length, Data - sizeof(Length), sizeof(Length));
+        return {Data, Length};
+    }
+    operator std::string_view() const { return str(); }
+};
+
+/// \brief StringPool keeps one copy of every string interned in it, in
+/// chunks freed all at once with the pool. IR names repeat a lot
+/// ('entry', 'ret.addr', ...), so they are stored out of line here
+/// instead of in every named object.
+/// Like the type context, it is meant for a single threaded environment.
+class StringPool {
+public:
+    StringPool() = default;
+    StringPool(const StringPool &) = delete;
+    StringPool &operator=(const StringPool &) = delete;
+    ~StringPool();
+
+    /// Return the interned copy of Str, the empty handle if Str is empty.
+    InternedString intern(std::string_view Str);
+    /// Return the number of distinct strings in the pool.
+    std::size_t size() const { return Strings.size(); }
+    /// Return the bytes held by the chunks of the pool.
+    std::size_t getTotalMemory() const { return TotalMemory; }
+
+private:
+    static constexpr std::size_t ChunkSize = 4096;
+
+    // Views of the interned characters.
+    std::unordered_set<std::string_view> Strings;
+    std::vector<char *> Chunks;
+    char *CurPtr = nullptr;
+    char *End = nullptr;
+    std::size_t TotalMemory = 0;
+};
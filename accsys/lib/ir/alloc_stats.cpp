@@ -0,0 +1,19 @@
+#include "utils/alloc_stats.h"
+
+AllocCounter AllocStats::Counters[static_cast<unsigned>(AllocKind::NumKinds)];
+
+const char *AllocStats::getKindName(AllocKind K) {
+    switch (K) {
+    case AllocKind::Instruction: return "Instruction";
+    case AllocKind::Use: return "Use";
+    case AllocKind::Argument: return "Argument";
+    case AllocKind::ConstantInt: return "ConstantInt";
+    case AllocKind::ConstantUnit: return "ConstantUnit";
+    case AllocKind::BasicBlock: return "BasicBlock";
+    case AllocKind::Function: return "Function";
+    case AllocKind::GlobalVariable: return "GlobalVariable";
+    case AllocKind::Type: return "Type";
+    case AllocKind::Name: return "Name";
+    default: return "<unknown>";
+    }
+}
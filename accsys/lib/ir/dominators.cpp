@@ -0,0 +1,582 @@
+#include "ir/dominators.h"
+#include "utils/bit_vector.h"
+
+#include <algorithm>
+#include <cassert>
+#include <queue>
+#include <utility>
+
+namespace {
+
+/// Edges of the graph the tree is built on, the CFG or the reverse CFG.
+template <bool IsPostDom, typename Fn>
+void forEachSuccessor(BasicBlock *BB, Fn F) {
+    if constexpr (IsPostDom) {
+        for (BasicBlock *Pred : BB->predecessors())
+            F(Pred);
+    } else {
+        for (BasicBlock *Succ : BB->successors())
+            if (Succ)
+                F(Succ);
+    }
+}
+
+template <bool IsPostDom, typename Fn>
+void forEachPredecessor(BasicBlock *BB, Fn F) {
+    forEachSuccessor<!IsPostDom>(BB, F);
+}
+
+/// \brief SemiNCA computes the immediate dominators of the blocks reached
+/// by one or more depth first searches, with the Semi-NCA algorithm
+/// (Georgiadis, Linear-Time Algorithms for Dominators and Related
+/// Problems). The first vertex is the root, and may be virtual.
+template <bool IsPostDom>
+class SemiNCA {
+    // By DFS number, which start at 1.
+    std::vector<BasicBlock *> Vertex {nullptr};
+    std::vector<unsigned> Parent {0};
+    std::vector<unsigned> Semi {0};
+    std::vector<unsigned> Label {0};
+    std::vector<unsigned> IDom {0};
+    // DFS number of the blocks, 0 if not reached.
+    IndexedMap<unsigned, BlockNumberIndex> Num;
+    std::vector<unsigned> EvalStack;
+
+    unsigned addVertex(BasicBlock *BB, unsigned ParentNum) {
+        unsigned N = Vertex.size();
+        if (BB)
+            Num[BB] = N;
+        Vertex.push_back(BB);
+        Parent.push_back(ParentNum);
+        Semi.push_back(N);
+        Label.push_back(N);
+        IDom.push_back(ParentNum);
+        return N;
+    }
+
+    // Return the vertex of least semidominator on the path from V up to
+    // the processed vertices, compressing the path on the way.
+    unsigned eval(unsigned V, unsigned LastLinked) {
+        if (Parent[V] < LastLinked)
+            return Label[V];
+        do {
+            EvalStack.push_back(V);
+            V = Parent[V];
+        } while (Parent[V] >= LastLinked);
+        unsigned P = V;
+        unsigned PLabel = Label[P];
+        do {
+            V = EvalStack.back();
+            EvalStack.pop_back();
+            Parent[V] = Parent[P];
+            if (Semi[PLabel] < Semi[Label[V]])
+                Label[V] = PLabel;
+            else
+                PLabel = Label[V];
+            P = V;
+        } while (!EvalStack.empty());
+        return Label[V];
+    }
+
+public:
+    explicit SemiNCA(const Function &F) {
+        if (F.getNumBlockNumbers())
+            Num.grow(F.getNumBlockNumbers() - 1);
+    }
+
+    unsigned getNum(const BasicBlock *BB) const { return Num.inBounds(BB) ? Num[BB] : 0; }
+    unsigned size() const { return Vertex.size() - 1; }
+    BasicBlock *getVertex(unsigned N) const { return Vertex[N]; }
+    BasicBlock *getIDomBlock(unsigned N) const { return Vertex[IDom[N]]; }
+
+    void addVirtualRoot() { addVertex(nullptr, 0); }
+
+    /// Search from Start, the child of vertex ParentNum, into the blocks
+    /// accepted by Descend.
+    template <typename DescendFn>
+    void runDFS(BasicBlock *Start, unsigned ParentNum, DescendFn Descend) {
+        std::vector<std::pair<BasicBlock *, unsigned>> Stack {{Start, ParentNum}};
+        while (!Stack.empty()) {
+            auto [BB, P] = Stack.back();
+            Stack.pop_back();
+            if (getNum(BB))
+                continue;
+            unsigned N = addVertex(BB, P);
+            // Pushed in reverse, so the first successor is visited first.
+            std::size_t Mark = Stack.size();
+            forEachSuccessor<IsPostDom>(BB, [&](BasicBlock *Succ) {
+                if (!getNum(Succ) && Descend(Succ))
+                    Stack.push_back({Succ, N});
+            });
+            std::reverse(Stack.begin() + Mark, Stack.end());
+        }
+    }
+
+    /// Compute the immediate dominators of the vertices reached.
+    void run() {
+        unsigned N = size();
+        // Semidominators, in reverse preorder.
+        for (unsigned i = N; i >= 2; --i) {
+            unsigned S = Parent[i];
+            forEachPredecessor<IsPostDom>(Vertex[i], [&](BasicBlock *Pred) {
+                if (unsigned V = getNum(Pred)) {
+                    unsigned SemiU = Semi[eval(V, i + 1)];
+                    if (SemiU < S)
+                        S = SemiU;
+                }
+            });
+            Semi[i] = S;
+        }
+        // The immediate dominator is the nearest common ancestor of the
+        // parent and the semidominator in the tree built so far.
+        for (unsigned i = 2; i <= N; ++i) {
+            unsigned Candidate = IDom[i];
+            while (Candidate > Semi[i])
+                Candidate = IDom[Candidate];
+            IDom[i] = Candidate;
+        }
+    }
+};
+
+} // namespace
+
+void DomTreeNode::setIDom(DomTreeNode *NewIDom) {
+    if (IDom == NewIDom)
+        return;
+    auto IT = std::find(IDom->Children.begin(), IDom->Children.end(), this);
+    assert(IT != IDom->Children.end() && "Not a child of its immediate dominator!");
+    IDom->Children.erase(IT);
+    IDom = NewIDom;
+    IDom->Children.push_back(this);
+    Level = IDom->Level + 1;
+}
+
+template <bool IsPostDom>
+DomTreeNode *DominatorTreeBase<IsPostDom>::createNode(BasicBlock *BB, DomTreeNode *IDom) {
+    unsigned Idx = BB->getNumber();
+    if (Idx >= Nodes.size())
+        Nodes.resize(Idx + 1);
+    assert(!Nodes[Idx] && "Block already in the tree!");
+    Nodes[Idx] = std::make_unique<DomTreeNode>(BB, IDom);
+    if (IDom)
+        IDom->Children.push_back(Nodes[Idx].get());
+    return Nodes[Idx].get();
+}
+
+template <bool IsPostDom>
+void DominatorTreeBase<IsPostDom>::recalculate(Function &F) {
+    Parent = &F;
+    Nodes.clear();
+    VirtualRoot.reset();
+    RootNode = nullptr;
+    Roots.clear();
+    ExitRootsOnly = true;
+    DFSInfoValid = false;
+    SlowQueries = 0;
+    if (F.empty())
+        return;
+
+    SemiNCA<IsPostDom> S(F);
+    if constexpr (IsPostDom) {
+        S.addVirtualRoot();
+        auto All = [](BasicBlock *) { return true; };
+        for (BasicBlock &BB : F) {
+            if (BB.getNumSuccessors() == 0) {
+                Roots.push_back(&BB);
+                S.runDFS(&BB, 1, All);
+            }
+        }
+        // Blocks that cannot reach an exit hang from the first block of
+        // their region.
+        for (BasicBlock &BB : F) {
+            if (!S.getNum(&BB)) {
+                Roots.push_back(&BB);
+                ExitRootsOnly = false;
+                S.runDFS(&BB, 1, All);
+            }
+        }
+    } else {
+        Roots.push_back(&F.getEntryBlock());
+        S.runDFS(Roots.front(), 0, [](BasicBlock *) { return true; });
+    }
+    S.run();
+
+    // In preorder, the immediate dominators come first.
+    std::vector<DomTreeNode *> NodeOf(S.size() + 1);
+    if constexpr (IsPostDom) {
+        VirtualRoot = std::make_unique<DomTreeNode>(nullptr, nullptr);
+        NodeOf[1] = RootNode = VirtualRoot.get();
+    } else {
+        NodeOf[1] = RootNode = createNode(S.getVertex(1), nullptr);
+    }
+    for (unsigned i = 2, e = S.size(); i <= e; ++i) {
+        BasicBlock *IDom = S.getIDomBlock(i);
+        NodeOf[i] = createNode(S.getVertex(i), IDom ? NodeOf[S.getNum(IDom)] : RootNode);
+    }
+}
+
+template <bool IsPostDom>
+void DominatorTreeBase<IsPostDom>::updateLevels(DomTreeNode *Top) {
+    std::vector<DomTreeNode *> Stack {Top};
+    while (!Stack.empty()) {
+        DomTreeNode *N = Stack.back();
+        Stack.pop_back();
+        for (DomTreeNode *Child : N->Children) {
+            Child->Level = N->Level + 1;
+            Stack.push_back(Child);
+        }
+    }
+}
+
+template <bool IsPostDom>
+void DominatorTreeBase<IsPostDom>::updateDFSNumbers() const {
+    unsigned DFSNum = 0;
+    if (RootNode) {
+        // The node and the index of its next child.
+        std::vector<std::pair<DomTreeNode *, std::size_t>> Stack {{RootNode, 0}};
+        RootNode->DFSNumIn = DFSNum++;
+        while (!Stack.empty()) {
+            auto &[N, NextChild] = Stack.back();
+            if (NextChild == N->Children.size()) {
+                N->DFSNumOut = DFSNum++;
+                Stack.pop_back();
+                continue;
+            }
+            DomTreeNode *Child = N->Children[NextChild++];
+            Child->DFSNumIn = DFSNum++;
+            Stack.push_back({Child, 0});
+        }
+    }
+    DFSInfoValid = true;
+    SlowQueries = 0;
+}
+
+template <bool IsPostDom>
+bool DominatorTreeBase<IsPostDom>::dominates(const DomTreeNode *A, const DomTreeNode *B) const {
+    if (!B)
+        return true;
+    if (!A)
+        return false;
+    if (A == B || B->IDom == A)
+        return true;
+    if (A->IDom == B || A->Level >= B->Level)
+        return false;
+    if (DFSInfoValid)
+        return B->dominatedBy(A);
+    // Walk up the tree for a few queries after a change before renumbering.
+    if (++SlowQueries > 32) {
+        updateDFSNumbers();
+        return B->dominatedBy(A);
+    }
+    while (B->Level > A->Level)
+        B = B->IDom;
+    return A == B;
+}
+
+template <bool IsPostDom>
+bool DominatorTreeBase<IsPostDom>::dominates(const Instruction *A, const Instruction *B) const {
+    const BasicBlock *BA = A->getParent();
+    const BasicBlock *BB = B->getParent();
+    if (BA != BB)
+        return dominates(BA, BB);
+    if (A == B)
+        return true;
+    return IsPostDom ? B->comesBefore(A) : A->comesBefore(B);
+}
+
+template <bool IsPostDom>
+DomTreeNode *DominatorTreeBase<IsPostDom>::findNearestCommonDominator(DomTreeNode *A, DomTreeNode *B) {
+    while (A != B) {
+        if (A->Level < B->Level)
+            std::swap(A, B);
+        A = A->IDom;
+    }
+    return A;
+}
+
+template <bool IsPostDom>
+BasicBlock *DominatorTreeBase<IsPostDom>::findNearestCommonDominator(BasicBlock *A, BasicBlock *B) const {
+    DomTreeNode *NA = getNode(A);
+    DomTreeNode *NB = getNode(B);
+    if (!NA || !NB)
+        return nullptr;
+    return findNearestCommonDominator(NA, NB)->Block;
+}
+
+template <bool IsPostDom>
+DomTreeNode *DominatorTreeBase<IsPostDom>::addNewBlock(BasicBlock *BB, BasicBlock *IDom) {
+    DomTreeNode *IDomNode = getNode(IDom);
+    assert(IDomNode && "Immediate dominator not in the tree!");
+    DFSInfoValid = false;
+    return createNode(BB, IDomNode);
+}
+
+template <bool IsPostDom>
+void DominatorTreeBase<IsPostDom>::eraseNode(BasicBlock *BB) {
+    DomTreeNode *N = getNode(BB);
+    assert(N && "Block not in the tree!");
+    assert(N->Children.empty() && "Erasing a node with children!");
+    if (DomTreeNode *IDom = N->IDom) {
+        auto IT = std::find(IDom->Children.begin(), IDom->Children.end(), N);
+        IDom->Children.erase(IT);
+    }
+    auto RootIT = std::find(Roots.begin(), Roots.end(), BB);
+    if (RootIT != Roots.end())
+        Roots.erase(RootIT);
+    if (N == RootNode)
+        RootNode = nullptr;
+    Nodes[BB->getNumber()].reset();
+    DFSInfoValid = false;
+}
+
+template <bool IsPostDom>
+void DominatorTreeBase<IsPostDom>::insertEdge(BasicBlock *From, BasicBlock *To) {
+    if constexpr (IsPostDom) {
+        // A new edge out of a root, or any change to a tree with roots
+        // other than exits, may change the roots.
+        if (!ExitRootsOnly || std::find(Roots.begin(), Roots.end(), From) != Roots.end() ||
+            !getNode(From) || !getNode(To)) {
+            recalculate(*Parent);
+            return;
+        }
+        insertReachable(getNode(To), getNode(From));
+    } else {
+        DomTreeNode *FromNode = getNode(From);
+        // Nothing changes for edges out of unreachable blocks.
+        if (!FromNode)
+            return;
+        if (DomTreeNode *ToNode = getNode(To))
+            insertReachable(FromNode, ToNode);
+        else
+            insertUnreachable(FromNode, To);
+    }
+}
+
+template <bool IsPostDom>
+void DominatorTreeBase<IsPostDom>::insertReachable(DomTreeNode *From, DomTreeNode *To) {
+    // The depth based search of Georgiadis et al. (An Experimental Study
+    // of Dynamic Dominators): a node is affected, and becomes a child of
+    // the nearest common dominator NCD, iff it is deeper than the children
+    // of NCD and reached from To by a path with no node shallower than it.
+    // The nodes are visited deepest first, with a bucket queue.
+    DomTreeNode *NCD = findNearestCommonDominator(From, To);
+    unsigned NCDLevel = NCD->Level;
+    if (NCDLevel + 1 >= To->Level)
+        return;
+
+    auto Shallower = [](const DomTreeNode *A, const DomTreeNode *B) { return A->Level < B->Level; };
+    std::priority_queue<DomTreeNode *, std::vector<DomTreeNode *>, decltype(Shallower)> Bucket(Shallower);
+    BitVector Visited(Parent->getNumBlockNumbers());
+    std::vector<DomTreeNode *> Affected;
+    std::vector<DomTreeNode *> UnaffectedOnCurrentLevel;
+    Bucket.push(To);
+    Visited.set(To->Block->getNumber());
+    while (!Bucket.empty()) {
+        DomTreeNode *N = Bucket.top();
+        Bucket.pop();
+        Affected.push_back(N);
+        unsigned CurrentLevel = N->Level;
+        while (true) {
+            forEachSuccessor<IsPostDom>(N->Block, [&](BasicBlock *Succ) {
+                DomTreeNode *SuccNode = getNode(Succ);
+                assert(SuccNode && "Unreachable successor of a reachable block!");
+                if (SuccNode->Level <= NCDLevel + 1 || Visited.test_and_set(Succ->getNumber()))
+                    return;
+                // Deeper nodes are not affected through this path, but
+                // lead on to the nodes that may be.
+                if (SuccNode->Level > CurrentLevel)
+                    UnaffectedOnCurrentLevel.push_back(SuccNode);
+                else
+                    Bucket.push(SuccNode);
+            });
+            if (UnaffectedOnCurrentLevel.empty())
+                break;
+            N = UnaffectedOnCurrentLevel.back();
+            UnaffectedOnCurrentLevel.pop_back();
+        }
+    }
+
+    for (DomTreeNode *N : Affected) {
+        N->setIDom(NCD);
+        updateLevels(N);
+    }
+    DFSInfoValid = false;
+}
+
+template <bool IsPostDom>
+void DominatorTreeBase<IsPostDom>::insertUnreachable(DomTreeNode *From, BasicBlock *To) {
+    // The blocks reached through the new edge form a tree of their own
+    // under From.
+    SemiNCA<IsPostDom> S(*Parent);
+    S.runDFS(To, 0, [this](BasicBlock *BB) { return !getNode(BB); });
+    S.run();
+    std::vector<DomTreeNode *> NodeOf(S.size() + 1);
+    NodeOf[1] = createNode(To, From);
+    for (unsigned i = 2, e = S.size(); i <= e; ++i)
+        NodeOf[i] = createNode(S.getVertex(i), NodeOf[S.getNum(S.getIDomBlock(i))]);
+    DFSInfoValid = false;
+
+    // Their edges back into the old tree are insertions of their own.
+    std::vector<std::pair<DomTreeNode *, DomTreeNode *>> Edges;
+    for (unsigned i = 1, e = S.size(); i <= e; ++i) {
+        forEachSuccessor<IsPostDom>(S.getVertex(i), [&](BasicBlock *Succ) {
+            if (!S.getNum(Succ))
+                Edges.push_back({NodeOf[i], getNode(Succ)});
+        });
+    }
+    for (auto [U, V] : Edges)
+        insertReachable(U, V);
+}
+
+template <bool IsPostDom>
+void DominatorTreeBase<IsPostDom>::deleteEdge(BasicBlock *From, BasicBlock *To) {
+    for (BasicBlock *Succ : From->successors())
+        if (Succ == To)
+            return;
+    if constexpr (IsPostDom) {
+        // From may have become an exit, or lost its way to one.
+        if (!ExitRootsOnly || From->getNumSuccessors() == 0 || !getNode(From) || !getNode(To)) {
+            recalculate(*Parent);
+            return;
+        }
+        std::swap(From, To);
+    }
+    DomTreeNode *FromNode = getNode(From);
+    DomTreeNode *ToNode = getNode(To);
+    if (!FromNode || !ToNode)
+        return;
+    // Only the nodes dominated by the nearest common dominator can change
+    // (Georgiadis et al., Lemma 2.6), unless To dominates From and the
+    // edge was a back edge that changes nothing.
+    DomTreeNode *NCD = findNearestCommonDominator(FromNode, ToNode);
+    if (NCD == ToNode)
+        return;
+    if (!NCD->Block) {
+        recalculate(*Parent);
+        return;
+    }
+    rebuildSubtree(NCD);
+}
+
+template <bool IsPostDom>
+void DominatorTreeBase<IsPostDom>::rebuildSubtree(DomTreeNode *Top) {
+    // Every path from the root into the subtree enters it through Top,
+    // so the subtree is rebuilt from the edges inside it. The search is
+    // kept to the marked subtree, the levels alone are not enough: the new
+    // edge of a retarget is in the CFG before insertEdge reports it, and
+    // may lead out of the subtree to a deeper node.
+    std::vector<DomTreeNode *> Subtree(Top->Children.begin(), Top->Children.end());
+    BitVector InSubtree(Parent->getNumBlockNumbers());
+    for (std::size_t i = 0; i != Subtree.size(); ++i) {
+        InSubtree.set(Subtree[i]->Block->getNumber());
+        Subtree.insert(Subtree.end(), Subtree[i]->Children.begin(), Subtree[i]->Children.end());
+    }
+
+    SemiNCA<IsPostDom> S(*Parent);
+    S.runDFS(Top->Block, 0, [&](BasicBlock *BB) { return InSubtree.test(BB->getNumber()); });
+    S.run();
+    if (IsPostDom && S.size() != Subtree.size() + 1) {
+        // Blocks that no longer reach an exit need a root of their own.
+        recalculate(*Parent);
+        return;
+    }
+
+    for (unsigned i = 2, e = S.size(); i <= e; ++i)
+        getNode(S.getVertex(i))->setIDom(getNode(S.getIDomBlock(i)));
+    // The blocks not reached are no longer reachable from the entry, nor
+    // dominate a block that is.
+    for (DomTreeNode *N : Subtree) {
+        if (S.getNum(N->Block))
+            continue;
+        if (S.getNum(N->IDom->Block)) {
+            auto IT = std::find(N->IDom->Children.begin(), N->IDom->Children.end(), N);
+            N->IDom->Children.erase(IT);
+        }
+    }
+    std::vector<BasicBlock *> Lost;
+    for (DomTreeNode *N : Subtree) {
+        if (!S.getNum(N->Block)) {
+            Lost.push_back(N->Block);
+            Nodes[N->Block->getNumber()].reset();
+        }
+    }
+    updateLevels(Top);
+    DFSInfoValid = false;
+
+    // The blocks beyond the subtree lost the edges from the unreachable
+    // blocks, their dominators may get deeper. Rebuild from the nearest
+    // common dominator of those too.
+    DomTreeNode *NewTop = Top;
+    for (BasicBlock *BB : Lost) {
+        forEachSuccessor<IsPostDom>(BB, [&](BasicBlock *Succ) {
+            DomTreeNode *SuccNode = getNode(Succ);
+            if (SuccNode && !S.getNum(Succ))
+                NewTop = findNearestCommonDominator(NewTop, SuccNode);
+        });
+    }
+    if (NewTop != Top)
+        rebuildSubtree(NewTop);
+}
+
+template <bool IsPostDom>
+bool DominatorTreeBase<IsPostDom>::verify() const {
+    if (!Parent)
+        return Nodes.empty();
+    DominatorTreeBase Fresh(*Parent);
+    if (Fresh.Roots != Roots)
+        return false;
+    for (BasicBlock &BB : *Parent) {
+        DomTreeNode *N = getNode(&BB);
+        DomTreeNode *FreshN = Fresh.getNode(&BB);
+        if (!N || !FreshN) {
+            if (N != FreshN)
+                return false;
+            continue;
+        }
+        if (N->Level != FreshN->Level || getIDom(&BB) != Fresh.getIDom(&BB))
+            return false;
+    }
+    // No node is left for a block gone from the function.
+    std::size_t NumNodes = std::count_if(Nodes.begin(), Nodes.end(), [](const auto &N) { return N != nullptr; });
+    std::size_t FreshNodes = std::count_if(Fresh.Nodes.begin(), Fresh.Nodes.end(), [](const auto &N) { return N != nullptr; });
+    return NumNodes == FreshNodes;
+}
+
+template class DominatorTreeBase<false>;
+template class DominatorTreeBase<true>;
+
+template <bool IsPostDom>
+void DominanceFrontierBase<IsPostDom>::calculate(const DominatorTreeBase<IsPostDom> &DT) {
+    Parent = DT.getParent();
+    Frontiers.clear();
+    if (!Parent || !Parent->getNumBlockNumbers())
+        return;
+    Frontiers.grow(Parent->getNumBlockNumbers() - 1);
+    // Walk up from every predecessor of a block to its immediate dominator,
+    // the block is in the frontier of the nodes on the way.
+    for (BasicBlock &BB : *const_cast<Function *>(Parent)) {
+        DomTreeNode *N = DT.getNode(&BB);
+        if (!N)
+            continue;
+        forEachPredecessor<IsPostDom>(&BB, [&](BasicBlock *Pred) {
+            for (DomTreeNode *Runner = DT.getNode(Pred); Runner && Runner != N->getIDom();
+                 Runner = Runner->getIDom()) {
+                auto &Frontier = Frontiers[Runner->getBlock()];
+                if (!Frontier.empty() && Frontier.back() == &BB)
+                    break;
+                Frontier.push_back(&BB);
+            }
+        });
+    }
+}
+
+template <bool IsPostDom>
+const std::vector<BasicBlock *> &DominanceFrontierBase<IsPostDom>::getFrontier(const BasicBlock *BB) const {
+    static const std::vector<BasicBlock *> Empty;
+    if (BB->getParent() != Parent || !Frontiers.inBounds(BB))
+        return Empty;
+    return Frontiers[BB];
+}
+
+template class DominanceFrontierBase<false>;
+template class DominanceFrontierBase<true>;
@@ -1,15 +1,62 @@
 #include "ir/ir.h"
 #include "ir/type.h"
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <string_view>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <fmt/core.h>
 
+/// The allocator of the module a new IR object is created into, or null
+/// for an object created detached, which then lives on the global heap.
+static SlabAllocator *allocatorOf(Module *M) {
+    return M ? &M->getAllocator() : nullptr;
+}
+
+static SlabAllocator *allocatorOf(Function *F) {
+    return F ? allocatorOf(F->getParent()) : nullptr;
+}
+
+static SlabAllocator *allocatorOf(BasicBlock *BB) {
+    return BB ? allocatorOf(BB->getParent()) : nullptr;
+}
+
+static SlabAllocator *allocatorOf(Instruction *I) {
+    return I ? allocatorOf(I->getParent()) : nullptr;
+}
+
+/// The string pool names are interned into, that of module M, or a per
+/// thread pool for objects not in a module.
+static StringPool &namePoolOf(Module *M) {
+    thread_local StringPool DetachedNames;
+    return M ? M->getNamePool() : DetachedNames;
+}
+
+/// The module a named value belongs to, if any.
+static Module *moduleOf(Value *V) {
+    if (auto *GV = dyn_cast<GlobalVariable>(V))
+        return GV->getParent();
+    Function *F = nullptr;
+    if (auto *I = dyn_cast<Instruction>(V)) {
+        if (BasicBlock *BB = I->getParent())
+            F = BB->getParent();
+    } else if (auto *Arg = dyn_cast<Argument>(V)) {
+        F = Arg->getParent();
+    }
+    return F ? F->getParent() : nullptr;
+}
+
 Use::Use(Value *Parent) : Parent(Parent) { }
 
+Use::~Use() {
+    if (Val)
+        Val->removeUse(*this);
+}
+
 
 void Use::removeFromList() {
     *Prev = Next;
@@ -29,7 +76,7 @@ void Use::addToList(Use **UseList) {
 
 void Use::set(Value *V) {
     if (Val)
-        removeFromList();
+        Val->removeUse(*this);
     Val = V;
     if (V)
         V->addUse(*this);
@@ -44,22 +91,30 @@ Value::~Value() {
     replaceAllUsesWith(nullptr);
 }
 
-unsigned Value::getNumUses() const {
-    auto view = getUserView();
-    unsigned size = 0;
-    for (auto I = view.begin(), IE = view.end(); I != IE; ++I)
-        ++size;
-    return size;
-}
-
 void Value::replaceAllUsesWith(Value *V) {
-    std::vector<Use *> Uses;
-    auto view = getUserView();
-    for (auto &I : view)
-        Uses.push_back(&I);
-    
-    for (auto I: Uses)
-        I->set(V);
+    if (V == this || !UserList)
+        return;
+    // Point the uses at V, then link the whole list in front of the uses of V.
+    Use *Last = nullptr;
+    for (Use *U = UserList, *Next; U; U = Next) {
+        Next = U->Next;
+        U->Val = V;
+        if (!V) {
+            U->Next = nullptr;
+            U->Prev = nullptr;
+        }
+        Last = U;
+    }
+    if (V) {
+        Last->Next = V->UserList;
+        if (V->UserList)
+            V->UserList->Prev = &Last->Next;
+        V->UserList = UserList;
+        UserList->Prev = &V->UserList;
+        V->NumUses += NumUses;
+    }
+    UserList = nullptr;
+    NumUses = 0;
 }
 
 void Value::setName(std::string_view NewName) {
@@ -72,19 +127,13 @@ void Value::setName(std::string_view NewName) {
     // Name isn't change?
     if (getName() == NewName)
         return;
-    // symbol table to update?
-    if (auto *GV = dyn_cast<GlobalVariable>(this)) {
-        auto &ST = GV->getParent()->getGlobalVariableMap();
-        if (!NewName.empty()) {
-            if (GV->hasName())
-                ST.erase(GV->getName());
-            ST[NewName] = GV;
-        } else {
-            ST.erase(GV->getName());
-        }
-    }
-    // set name.
-    Name = NewName;
+    // set name, the symbol table refers to the interned copy.
+    auto *GV = dyn_cast<GlobalVariable>(this);
+    if (GV && GV->getParent() && GV->hasName())
+        GV->getParent()->getGlobalVariableMap().erase(GV->getName());
+    Name = namePoolOf(moduleOf(this)).intern(NewName);
+    if (GV && GV->getParent() && GV->hasName())
+        GV->getParent()->getGlobalVariableMap()[GV->getName()] = GV;
 }
 
 bool Value::hasName() const {
@@ -95,34 +144,91 @@ bool Value::hasName() const {
 Constant::Constant(Type *Ty, unsigned VT)
     : Value(Ty, VT) {}
 
+namespace {
+/// The uniqued constants. Like the type context, there is one per thread,
+/// and it deletes the constants still alive when the thread exits.
+struct ConstantContext {
+    std::unordered_map<std::uint32_t, ConstantInt *> Ints;
+    ConstantUnit *Unit = nullptr;
+
+    ~ConstantContext() {
+        // The destructors of the constants look themselves up in the
+        // pool, so it is emptied before they run.
+        auto Pending = std::move(Ints);
+        Ints.clear();
+        for (auto &[Val, C] : Pending)
+            delete C;
+        delete Unit;
+    }
+};
+
+thread_local ConstantContext Constants;
+}
+
 ConstantInt::ConstantInt(std::uint32_t Val)
     : Constant(Type::getIntegerTy(), Value::ConstantIntVal),
       value(Val) {}
 
+ConstantInt::~ConstantInt() {
+    auto IT = Constants.Ints.find(value);
+    if (IT != Constants.Ints.end() && IT->second == this)
+        Constants.Ints.erase(IT);
+}
+
 ConstantInt *ConstantInt::Create(std::uint32_t Val) {
-    return new ConstantInt(Val);
+    ConstantInt *&C = Constants.Ints[Val];
+    if (!C)
+        C = new ConstantInt(Val);
+    return C;
 }
 
 ConstantUnit::ConstantUnit()
     : Constant(Type::getUnitTy(), Value::ConstantUnitVal) {}
 
+ConstantUnit::~ConstantUnit() {
+    if (Constants.Unit == this)
+        Constants.Unit = nullptr;
+}
+
 ConstantUnit *ConstantUnit::Create() {
-    return new ConstantUnit;
+    if (!Constants.Unit)
+        Constants.Unit = new ConstantUnit;
+    return Constants.Unit;
 }
 
 
-Instruction::Instruction(Type *Ty, unsigned Opcode, 
-                         const std::vector<Value *> &Ops,
+void *Instruction::operator new(std::size_t Size, SlabAllocator *A, unsigned NumOps) {
+    // [operands][operand count][owner][instruction]
+    std::size_t Prefix = NumOps * sizeof(Use) + sizeof(std::size_t);
+    AllocStats::allocate(AllocKind::Instruction, Size);
+    char *Obj = static_cast<char *>(SlabAllocator::allocateOwned(A, Size, Prefix));
+    new (Obj - OperandGap) std::size_t(NumOps);
+    return Obj;
+}
+
+void Instruction::operator delete(void *Ptr, std::size_t Size) {
+    std::size_t NumOps = *reinterpret_cast<std::size_t *>(static_cast<char *>(Ptr) - OperandGap);
+    AllocStats::deallocate(AllocKind::Instruction, Size);
+    SlabAllocator::deallocateOwned(Ptr, Size, NumOps * sizeof(Use) + sizeof(std::size_t));
+}
+
+Instruction::Instruction(Type *Ty, unsigned Opcode, [[maybe_unused]] unsigned NumOps,
                          Instruction *InsertBefore) 
-    : Value(Ty, Value::InstructionVal + Opcode),
-      NumUserOperands(Ops.size()) {
-    if (NumUserOperands > 0) {
-        Uses = std::allocator<Use>().allocate(NumUserOperands);
-        for (unsigned i = 0, e = NumUserOperands; i != e; ++i) {
-            new (Uses + i) Use(this);
-            Uses[i].set(Ops[i]);
-        }
-    }
+    : Value(Ty, Value::InstructionVal + Opcode) {
+    assert(getNumOperands() == NumOps && "Instruction allocated with another number of operands!");
+    initUses();
+    insertAt(InsertBefore);
+}
+
+Instruction::Instruction(Type *Ty, unsigned Opcode, [[maybe_unused]] unsigned NumOps,
+                         BasicBlock *InsertAtEnd)
+    : Value(Ty, Value::InstructionVal + Opcode) {
+    assert(getNumOperands() == NumOps && "Instruction allocated with another number of operands!");
+    initUses();
+    insertAt(InsertAtEnd);
+}
+
+void Instruction::insertAt(Instruction *InsertBefore) {
     if (InsertBefore) {
         BasicBlock *BB = InsertBefore->getParent();
         assert(BB && "Instruction to insert before is not in a basic block!");
@@ -130,37 +236,89 @@ Instruction::Instruction(Type *Ty, unsigned Opcode,
     }
 }
 
-Instruction::Instruction(Type *Ty, unsigned Opcode,
-                         const std::vector<Value *> &Ops, 
-                         BasicBlock *InsertAtEnd)
-    : Value(Ty, Value::InstructionVal + Opcode), 
-      NumUserOperands(Ops.size()) {
-    if (NumUserOperands > 0) {
-        Uses = std::allocator<Use>().allocate(NumUserOperands);
-        for (unsigned i = 0, e = NumUserOperands; i != e; ++i) {
-            new (Uses + i) Use(this);
-            Uses[i].set(Ops[i]);
-        }
-    }
+void Instruction::insertAt(BasicBlock *InsertAtEnd) {
     if (InsertAtEnd) {
         insertInto(InsertAtEnd, InsertAtEnd->end());
     }
 }
 
+void Instruction::initUses() {
+    unsigned NumUserOperands = getNumOperands();
+    if (NumUserOperands > 0) {
+        Use *Uses = getOperandList();
+        AllocStats::allocate(AllocKind::Use, NumUserOperands * sizeof(Use), NumUserOperands);
+        for (unsigned i = 0, e = NumUserOperands; i != e; ++i)
+            new (Uses + i) Use(this);
+    }
+}
+
+void Instruction::initOperands(ArrayRef<Value *> Ops, unsigned First) {
+    assert(First + Ops.size() <= getNumOperands() && "Too many operands!");
+    Use *Uses = getOperandList() + First;
+    for (unsigned i = 0, e = Ops.size(); i != e; ++i)
+        Uses[i].set(Ops[i]);
+}
+
 Instruction::~Instruction() {
+    // The operands are freed along with the instruction by operator delete.
+    unsigned NumUserOperands = getNumOperands();
     if (NumUserOperands > 0) {
+        Use *Uses = getOperandList();
         for (unsigned i = 0, e = NumUserOperands; i != e; ++i) {
             Uses[i].~Use();
         }
-        std::allocator<Use>().deallocate(Uses, NumUserOperands);
-        Uses = nullptr;
+        AllocStats::deallocate(AllocKind::Use, NumUserOperands * sizeof(Use), NumUserOperands);
     }
+    if (Parent && Parent->getParent())
+        Parent->getParent()->releaseValueNumber(Number);
 }
 
 void Instruction::setParent(BasicBlock *BB) {
+    // Moving to another function, or in and out of one, changes the number.
+    Function *OldF = Parent ? Parent->getParent() : nullptr;
+    Function *NewF = BB ? BB->getParent() : nullptr;
+    if (OldF != NewF) {
+        if (OldF)
+            OldF->releaseValueNumber(Number);
+        if (NewF)
+            Number = NewF->allocateValueNumber();
+    }
+    // The CFG edges of a terminator follow it.
+    if (BB != Parent) {
+        for (unsigned i = 0, e = getNumSuccessors(); i != e; ++i) {
+            BasicBlock *Succ = getSuccessorRef(i);
+            if (!Succ)
+                continue;
+            if (Parent)
+                Succ->removePredecessorEdge(Parent);
+            if (BB)
+                Succ->addPredecessorEdge(BB);
+        }
+    }
     Parent = BB;
 }
 
+void Instruction::setSuccessor(unsigned i, BasicBlock *BB) {
+    BasicBlock *&Succ = getSuccessorRef(i);
+    if (Succ == BB)
+        return;
+    if (Parent) {
+        if (Succ)
+            Succ->removePredecessorEdge(Parent);
+        if (BB)
+            BB->addPredecessorEdge(Parent);
+    }
+    Succ = BB;
+}
+
+void Instruction::dropSuccessorEdges() {
+    if (!Parent)
+        return;
+    for (unsigned i = 0, e = getNumSuccessors(); i != e; ++i)
+        if (BasicBlock *Succ = getSuccessorRef(i))
+            Succ->removePredecessorEdge(Parent);
+}
+
 void Instruction::insertBefore(Instruction *InsertBefore) {
     insertBefore(BasicBlock::iterator(InsertBefore));
 }
@@ -173,6 +331,7 @@ void Instruction::insertBefore(BasicBlock::iterator InsertBefore) {
 void Instruction::insertBefore(BasicBlock &BB, InstListType::iterator IT) {
     BB.getInstList().insert(IT, this);
     setParent(&BB);
+    BB.instructionInserted(this);
 }
 
 void Instruction::insertAfter(Instruction *InsertPos) {
@@ -180,6 +339,7 @@ void Instruction::insertAfter(Instruction *InsertPos) {
 
     DestParent->getInstList().insertAfter(BasicBlock::iterator(InsertPos), this);
     setParent(DestParent);
+    DestParent->instructionInserted(this);
 }
 
 BasicBlock::iterator Instruction::insertInto(BasicBlock *BB, BasicBlock::iterator IT) {
@@ -192,6 +352,14 @@ BasicBlock::iterator Instruction::insertInto(BasicBlock *BB, BasicBlock::iterato
 
 void Instruction::removeFromParent() {
     getParent()->getInstList().remove(BasicBlock::iterator(this));
+    setParent(nullptr);
+}
+
+bool Instruction::comesBefore(const Instruction *Other) const {
+    assert(Parent && Other->Parent == Parent && "Instructions not in the same basic block!");
+    if (!Parent->isInstrOrderValid())
+        Parent->renumberInstructions();
+    return Order < Other->Order;
 }
 
 BasicBlock::iterator Instruction::eraseFromParent() {
@@ -202,40 +370,40 @@ BasicBlock::iterator Instruction::eraseFromParent() {
 
 BinaryInst::BinaryInst(BinaryOps Op, Value *LHS, Value *RHS, Type *Ty,
                        Instruction *InsertBefore) 
-    : Instruction(Ty, Op, std::vector<Value *> {LHS, RHS}, InsertBefore) {
-
+    : Instruction(Ty, Op, 2, InsertBefore) {
+    initOperands({LHS, RHS});
 }
 
 BinaryInst::BinaryInst(BinaryOps Op, Value *LHS, Value *RHS, Type *Ty,
                        BasicBlock *InsertAtEnd)
-    : Instruction(Ty, Op, std::vector<Value *> {LHS, RHS}, InsertAtEnd) {
-
+    : Instruction(Ty, Op, 2, InsertAtEnd) {
+    initOperands({LHS, RHS});
 }
 
 BinaryInst *BinaryInst::Create(BinaryOps Op, Value *LHS, Value *RHS, Type *Ty,
                               Instruction *InsertBefore) {
     assert(LHS->getType() == RHS->getType() &&
         "Cannot create binary operator with two operands of differing type!");
-    return new BinaryInst(Op, LHS, RHS, Ty, InsertBefore);
+    return new (allocatorOf(InsertBefore), 2) BinaryInst(Op, LHS, RHS, Ty, InsertBefore);
 }
     
 BinaryInst *BinaryInst::Create(BinaryOps Op, Value *LHS, Value *RHS, Type *Ty,
                               BasicBlock *InsertAtEnd) {
-    auto *Res = Create(Op, LHS, RHS, Ty);
-    Res->insertInto(InsertAtEnd, InsertAtEnd->end());
-    return Res;
+    assert(LHS->getType() == RHS->getType() &&
+        "Cannot create binary operator with two operands of differing type!");
+    return new (allocatorOf(InsertAtEnd), 2) BinaryInst(Op, LHS, RHS, Ty, InsertAtEnd);
 }
 
 AllocaInst::AllocaInst(Type *PointeeType, std::size_t NumElements, Instruction *InsertBefore)
     : Instruction(PointerType::get(PointeeType), Instruction::Alloca, 
-    { }, InsertBefore),
+    0, InsertBefore),
       AllocatedType(PointeeType), NumElements(NumElements) {
     assert(!PointeeType->isUnitTy() && "Cannot allocate () type!");
 }
 
 AllocaInst::AllocaInst(Type *PointeeType, std::size_t NumElements, BasicBlock *InsertAtEnd)
     : Instruction(PointerType::get(PointeeType), Instruction::Alloca, 
-    { }, InsertAtEnd),
+    0, InsertAtEnd),
       AllocatedType(PointeeType), NumElements(NumElements) {
     assert(!PointeeType->isUnitTy() && "Cannot allocate () type!");
 }
@@ -243,58 +411,54 @@ AllocaInst::AllocaInst(Type *PointeeType, std::size_t NumElements, BasicBlock *I
 
 AllocaInst *AllocaInst::Create(Type *PointeeTy, std::size_t NumElements,
                               Instruction *InsertBefore) {
-    return new AllocaInst(PointeeTy, NumElements, InsertBefore);
+    return new (allocatorOf(InsertBefore), 0) AllocaInst(PointeeTy, NumElements, InsertBefore);
 }
 
 AllocaInst *AllocaInst::Create(Type *PointeeTy, std::size_t NumElements,
                               BasicBlock *InsertAtEnd) {
-    auto *Res = Create(PointeeTy, NumElements);
-    Res->insertInto(InsertAtEnd, InsertAtEnd->end());
-    return Res;
+    return new (allocatorOf(InsertAtEnd), 0) AllocaInst(PointeeTy, NumElements, InsertAtEnd);
 }
 
 StoreInst::StoreInst(Value *Val, Value *Ptr, Instruction *InsertBefore)
-    : Instruction(Type::getUnitTy(), Instruction::Store, { Val, Ptr }, InsertBefore) {
-
+    : Instruction(Type::getUnitTy(), Instruction::Store, 2, InsertBefore) {
+    initOperands({Val, Ptr});
 }
 
 StoreInst::StoreInst(Value *Val, Value *Ptr, BasicBlock *InsertAtEnd)
-    : Instruction(Type::getUnitTy(), Instruction::Store, { Val, Ptr }, InsertAtEnd) {
-        
+    : Instruction(Type::getUnitTy(), Instruction::Store, 2, InsertAtEnd) {
+    initOperands({Val, Ptr});
 }
 
 StoreInst *StoreInst::Create(Value *Val, Value *Ptr,
                              Instruction *InsertBefore) {
-    return new StoreInst(Val, Ptr, InsertBefore);
+    return new (allocatorOf(InsertBefore), 2) StoreInst(Val, Ptr, InsertBefore);
 }
 
 StoreInst *StoreInst::Create(Value *Val, Value *Ptr,
                              BasicBlock *InsertAtEnd) {
-    auto *Res = Create(Val, Ptr);
-    Res->insertInto(InsertAtEnd, InsertAtEnd->end());
-    return Res;
+    return new (allocatorOf(InsertAtEnd), 2) StoreInst(Val, Ptr, InsertAtEnd);
 }
 
 LoadInst::LoadInst(Value *Ptr, Instruction *InsertBefore)
     : Instruction(dyn_cast<PointerType>(Ptr->getType())->getElementType(),
-    Instruction::Load, { Ptr }, InsertBefore) {
+    Instruction::Load, 1, InsertBefore) {
+    initOperands(Ptr);
     assert(Ptr->getType()->isPointerTy() && "Cannot load from non-pointer type!");
 }
 
 LoadInst::LoadInst(Value *Ptr, BasicBlock *InsertAtEnd)
     : Instruction(dyn_cast<PointerType>(Ptr->getType())->getElementType(),
-    Instruction::Load, { Ptr }, InsertAtEnd) {
+    Instruction::Load, 1, InsertAtEnd) {
+    initOperands(Ptr);
     assert(Ptr->getType()->isPointerTy() && "Cannot load from non-pointer type!");
 }
 
 LoadInst *LoadInst::Create(Value *Ptr, Instruction *InsertBefore) {
-    return new LoadInst(Ptr, InsertBefore);
+    return new (allocatorOf(InsertBefore), 1) LoadInst(Ptr, InsertBefore);
 }
 
 LoadInst *LoadInst::Create(Value *Ptr, BasicBlock *InsertAtEnd) {
-    auto *Res = Create(Ptr);
-    Res->insertInto(InsertAtEnd, InsertAtEnd->end());
-    return Res;
+    return new (allocatorOf(InsertAtEnd), 1) LoadInst(Ptr, InsertAtEnd);
 }
 
 void OffsetInst::AssertOK() const {
@@ -304,45 +468,46 @@ void OffsetInst::AssertOK() const {
     assert(getNumOperands() == (unsigned)(bounds().size() + 1) && "Num of indices and bounds does not match!");
 }
 
-OffsetInst::OffsetInst(Type *PointeeTy,
-               std::vector <Value *> &Ops,
-               std::vector <std::optional<std::size_t>> &Bounds,
+OffsetInst::OffsetInst(Type *PointeeTy, Value *Ptr,
+               ArrayRef<Value *> Indices,
+               ArrayRef<std::optional<std::size_t>> Bounds,
                Instruction *InsertBefore) 
-    : Instruction(PointerType::get(PointeeTy), Instruction::Offset, Ops, InsertBefore),
+    : Instruction(PointerType::get(PointeeTy), Instruction::Offset,
+                  1 + Indices.size(), InsertBefore),
       ElementTy(PointeeTy),
-      Bounds(Bounds) {
+      Bounds(Bounds.vec()) {
+    initOperands(Ptr);
+    initOperands(Indices, 1);
     AssertOK();
 }
 
-OffsetInst::OffsetInst(Type *PointeeTy,
-               std::vector <Value *> &Ops,
-               std::vector <std::optional<std::size_t>> &Bounds,
+OffsetInst::OffsetInst(Type *PointeeTy, Value *Ptr,
+               ArrayRef<Value *> Indices,
+               ArrayRef<std::optional<std::size_t>> Bounds,
                BasicBlock *InsertAtEnd) 
-    : Instruction(PointerType::get(PointeeTy), Instruction::Offset, Ops, InsertAtEnd),
+    : Instruction(PointerType::get(PointeeTy), Instruction::Offset,
+                  1 + Indices.size(), InsertAtEnd),
       ElementTy(PointeeTy),
-      Bounds(Bounds) {
+      Bounds(Bounds.vec()) {
+    initOperands(Ptr);
+    initOperands(Indices, 1);
     AssertOK();
 }
 
 OffsetInst *OffsetInst::Create(Type *PointeeTy, Value *Ptr,
-                              std::vector <Value *> &Indices,
-                              std::vector <std::optional<std::size_t>> &Bounds,
+                              ArrayRef<Value *> Indices,
+                              ArrayRef<std::optional<std::size_t>> Bounds,
                               Instruction *InsertBefore) {
-    std::vector<Value *> Ops { Ptr };
-    Ops.insert(Ops.end(), Indices.begin(), Indices.end());
-    return new OffsetInst(PointeeTy, Ops, Bounds, InsertBefore);
+    return new (allocatorOf(InsertBefore), 1 + Indices.size())
+        OffsetInst(PointeeTy, Ptr, Indices, Bounds, InsertBefore);
 }
 
 OffsetInst *OffsetInst::Create(Type *PointeeTy, Value *Ptr,
-                              std::vector <Value *> &Indices,
-                              std::vector <std::optional<std::size_t>> &Bounds,
+                              ArrayRef<Value *> Indices,
+                              ArrayRef<std::optional<std::size_t>> Bounds,
                               BasicBlock *InsertAtEnd) {
-
-    std::vector<Value *> Ops { Ptr };
-    Ops.insert(Ops.end(), Indices.begin(), Indices.end());
-    auto *Res = new OffsetInst(PointeeTy, Ops, Bounds);
-    Res->insertInto(InsertAtEnd, InsertAtEnd->end());
-    return Res;
+    return new (allocatorOf(InsertAtEnd), 1 + Indices.size())
+        OffsetInst(PointeeTy, Ptr, Indices, Bounds, InsertAtEnd);
 }
 
 
@@ -372,73 +537,75 @@ bool OffsetInst::accumulateConstantOffset(std::size_t &Offset) const {
 }
 
 CallInst::CallInst(Function *Callee, 
-                   const std::vector<Value *> &Args,
+                   ArrayRef<Value *> Args,
                    Instruction *InsertBefore)
-    : Instruction(Callee->getReturnType(), Instruction::Call, Args, InsertBefore),
+    : Instruction(Callee->getReturnType(), Instruction::Call, Args.size(), InsertBefore),
       Callee(Callee) {
+    initOperands(Args);
     assert(Callee->getNumParams() == Args.size() && "Number of arguments does not match number of parameters!");
 }
 
 CallInst::CallInst(Function *Callee, 
-                   const std::vector<Value *> &Args,
+                   ArrayRef<Value *> Args,
                    BasicBlock *InsertAtEnd)
-    : Instruction(Callee->getReturnType(), Instruction::Call, Args, InsertAtEnd),
+    : Instruction(Callee->getReturnType(), Instruction::Call, Args.size(), InsertAtEnd),
       Callee(Callee) {
+    initOperands(Args);
     assert(Callee->getNumParams() == Args.size() && "Number of arguments does not match number of parameters!");
 }
 
 CallInst *CallInst::Create(Function *Callee, 
-                           const std::vector<Value *> &Args,
+                           ArrayRef<Value *> Args,
                            Instruction *InsertBefore) {
-    return new CallInst(Callee, Args, InsertBefore);
+    return new (allocatorOf(InsertBefore), Args.size()) CallInst(Callee, Args, InsertBefore);
 }
 
 CallInst *CallInst::Create(Function *Callee, 
-                           const std::vector<Value *> &Args,
+                           ArrayRef<Value *> Args,
                            BasicBlock *InsertAtEnd) {
-    auto *Res = Create(Callee, Args);
-    Res->insertInto(InsertAtEnd, InsertAtEnd->end());
-    return Res;
+    return new (allocatorOf(InsertAtEnd), Args.size()) CallInst(Callee, Args, InsertAtEnd);
 }
 
 JumpInst::JumpInst(BasicBlock *Dest, Instruction *InsertBefore)
-    : Instruction(Type::getUnitTy(), Instruction::Jump, { }, InsertBefore),
+    : Instruction(Type::getUnitTy(), Instruction::Jump, 0, static_cast<Instruction *>(nullptr)),
       Dest(Dest) {
+    insertAt(InsertBefore);
 }
 
 JumpInst::JumpInst(BasicBlock *Dest, BasicBlock *InsertAtEnd)
-    : Instruction(Type::getUnitTy(), Instruction::Jump, { }, InsertAtEnd),
+    : Instruction(Type::getUnitTy(), Instruction::Jump, 0, static_cast<BasicBlock *>(nullptr)),
       Dest(Dest) {
+    insertAt(InsertAtEnd);
+}
+
+JumpInst::~JumpInst() {
+    dropSuccessorEdges();
 }
 
 JumpInst *JumpInst::Create(BasicBlock *Dest, Instruction *InsertBefore) {
-    return new JumpInst(Dest, InsertBefore);
+    return new (allocatorOf(InsertBefore), 0) JumpInst(Dest, InsertBefore);
 }
 
 JumpInst *JumpInst::Create(BasicBlock *Dest, BasicBlock *InsertAtEnd) {
-    auto *Res = Create(Dest);
-    Res->insertInto(InsertAtEnd, InsertAtEnd->end());
-    return Res;
+    return new (allocatorOf(InsertAtEnd), 0) JumpInst(Dest, InsertAtEnd);
 }
 
 RetInst::RetInst(Value *Val, Instruction *InsertBefore)
-    : Instruction(Type::getUnitTy(), Instruction::Ret, { Val }, InsertBefore) {
-
+    : Instruction(Type::getUnitTy(), Instruction::Ret, 1, InsertBefore) {
+    initOperands(Val);
 }
 
 RetInst::RetInst(Value *Val, BasicBlock *InsertAtEnd)
-    : Instruction(Type::getUnitTy(), Instruction::Ret, { Val }, InsertAtEnd) {
-
+    : Instruction(Type::getUnitTy(), Instruction::Ret, 1, InsertAtEnd) {
+    initOperands(Val);
 }
 
 RetInst *RetInst::Create(Value *Val, Instruction *InsertBefore) {
-    return new RetInst(Val, InsertBefore);
+    return new (allocatorOf(InsertBefore), 1) RetInst(Val, InsertBefore);
 }
 
 RetInst *RetInst::Create(Value *Val, BasicBlock *InsertAtEnd) {
-    auto *Res = Create(Val);
-    Res->insertInto(InsertAtEnd, InsertAtEnd->end());
-    return Res;
+    return new (allocatorOf(InsertAtEnd), 1) RetInst(Val, InsertAtEnd);
 }
 
 void BranchInst::AssertOK() const {
@@ -448,52 +615,56 @@ void BranchInst::AssertOK() const {
 
 BranchInst::BranchInst(BasicBlock *IfTrue, BasicBlock *IfFalse, Value *Cond, Instruction *InsertBefore)
     : Instruction(Type::getUnitTy(), Instruction::Br, 
-    { Cond }, InsertBefore),
+    1, static_cast<Instruction *>(nullptr)),
       IfTrue(IfTrue), IfFalse(IfFalse) {
+    initOperands(Cond);
     AssertOK();
+    insertAt(InsertBefore);
 } 
 
 BranchInst::BranchInst(BasicBlock *IfTrue, BasicBlock *IfFalse, Value *Cond, BasicBlock *InsertAtEnd)
     : Instruction(Type::getUnitTy(), Instruction::Br,
-    { Cond }, InsertAtEnd),
+    1, static_cast<BasicBlock *>(nullptr)),
       IfTrue(IfTrue), IfFalse(IfFalse) {
+    initOperands(Cond);
     AssertOK();
+    insertAt(InsertAtEnd);
+}
+
+BranchInst::~BranchInst() {
+    dropSuccessorEdges();
 }
 
 
 BranchInst *BranchInst::Create(BasicBlock *IfTrue, BasicBlock *IfFalse, 
                               Value *Cond, 
                               Instruction *InsertBefore) {
-    return new BranchInst(IfTrue, IfFalse, Cond, InsertBefore);
+    return new (allocatorOf(InsertBefore), 1) BranchInst(IfTrue, IfFalse, Cond, InsertBefore);
 }
 
 BranchInst *BranchInst::Create(BasicBlock *IfTrue, BasicBlock *IfFalse, 
                               Value *Cond, 
                               BasicBlock *InsertAtEnd) {
-    auto *Res = Create(IfTrue, IfFalse, Cond);
-    Res->insertInto(InsertAtEnd, InsertAtEnd->end());
-    return Res;
+    return new (allocatorOf(InsertAtEnd), 1) BranchInst(IfTrue, IfFalse, Cond, InsertAtEnd);
 }
 
 
 PanicInst::PanicInst(Instruction *InsertBefore)
-    : Instruction(Type::getUnitTy(), Instruction::Panic, { }, InsertBefore) {
+    : Instruction(Type::getUnitTy(), Instruction::Panic, 0, InsertBefore) {
 
 }
 
 PanicInst::PanicInst(BasicBlock *InsertAtEnd)
-    : Instruction(Type::getUnitTy(), Instruction::Panic, { }, InsertAtEnd) {
+    : Instruction(Type::getUnitTy(), Instruction::Panic, 0, InsertAtEnd) {
 
 }
 
 PanicInst *PanicInst::Create(Instruction *InsertBefore) {
-    return new PanicInst(InsertBefore);
+    return new (allocatorOf(InsertBefore), 0) PanicInst(InsertBefore);
 }
 
 PanicInst *PanicInst::Create(BasicBlock *InsertAtEnd) {
-    auto *Res = Create();
-    Res->insertInto(InsertAtEnd, InsertAtEnd->end());
-    return Res;
+    return new (allocatorOf(InsertAtEnd), 0) PanicInst(InsertAtEnd);
 }
 
 BasicBlock::BasicBlock(Function *Parent, BasicBlock *InsertBefore)
@@ -517,22 +688,101 @@ void BasicBlock::insertInto(Function *NewParent, BasicBlock *InsertBefore) {
     setParent(NewParent);
 }
 
+void BasicBlock::removeFromParent() {
+    Parent->getBasicBlockList().remove(Function::iterator(this));
+    setParent(nullptr);
+}
+
+Function::iterator BasicBlock::eraseFromParent() {
+    return Parent->getBasicBlockList().erase(Function::iterator(this));
+}
+
 BasicBlock *BasicBlock::Create(Function *Parent, BasicBlock *InsertBefore) {
-    return new BasicBlock(Parent, InsertBefore);
+    return new (allocatorOf(Parent)) BasicBlock(Parent, InsertBefore);
 }
 
 
+BasicBlock::~BasicBlock() {
+    // The instructions give their numbers and edges back first.
+    InstList.clear();
+    // Terminators still branching here are left with a null successor.
+    for (BasicBlock *Pred : Preds)
+        for (Instruction &I : *Pred)
+            for (unsigned i = 0, e = I.getNumSuccessors(); i != e; ++i)
+                if (I.getSuccessorRef(i) == this)
+                    I.getSuccessorRef(i) = nullptr;
+    if (Parent)
+        Parent->releaseBlockNumber(Number);
+}
+
 void BasicBlock::setParent(Function *Parent) {
+    if (this->Parent == Parent)
+        return;
+    if (Function *OldF = this->Parent) {
+        OldF->releaseBlockNumber(Number);
+        for (Instruction &I : InstList)
+            OldF->releaseValueNumber(I.Number);
+    }
+    if (Parent) {
+        Number = Parent->allocateBlockNumber();
+        for (Instruction &I : InstList)
+            I.Number = Parent->allocateValueNumber();
+    }
     this->Parent = Parent;
 }
 
+void BasicBlock::instructionInserted(Instruction *I) {
+    if (!InstOrderValid)
+        return;
+    // Appending, as building the IR does, keeps the order ascending.
+    if (I == &InstList.back()) {
+        if (I == &InstList.front())
+            I->Order = 0;
+        else
+            I->Order = I->getPrevNode()->Order + 1;
+        return;
+    }
+    InstOrderValid = false;
+}
+
+void BasicBlock::removePredecessorEdge(BasicBlock *Pred) {
+    // Edges are unordered, so move the last one into the hole.
+    auto IT = std::find(Preds.begin(), Preds.end(), Pred);
+    assert(IT != Preds.end() && "Not a predecessor of the block!");
+    *IT = Preds.back();
+    Preds.pop_back();
+}
+
+void BasicBlock::renumberInstructions() const {
+    unsigned Order = 0;
+    for (const Instruction &I : *this)
+        I.Order = Order++;
+    InstOrderValid = true;
+}
+
+void BasicBlock::splice(iterator ToIT, BasicBlock *FromBB, iterator First, iterator Last) {
+    if (First == Last)
+        return;
+    if (FromBB == this) {
+        InstList.splice(ToIT, InstList, First, Last);
+    } else {
+        // The parents are updated anyway, count the moved instructions
+        // on the way.
+        std::size_t N = 0;
+        for (iterator IT = First; IT != Last; ++IT, ++N)
+            IT->setParent(this);
+        InstList.splice(ToIT, FromBB->InstList, First, Last, N);
+    }
+    invalidateOrders();
+}
+
 bool BasicBlock::hasName() const {
     return !Name.empty();
 }
 
 
 void BasicBlock::setName(std::string_view Name) {
-    this->Name = Name;
+    this->Name = namePoolOf(Parent ? Parent->getParent() : nullptr).intern(Name);
 }
 
 
@@ -543,13 +793,16 @@ Argument::Argument(Type *Ty, Function *Parent, unsigned ArgNo)
 Function::Function(FunctionType *FTy, bool ExternalLinkage,
                    std::string_view Name, Module *M)
     : FTy(FTy), NumArgs(FTy->getNumParams()),
-      ExternalLinkage(ExternalLinkage), Name(Name), Parent(M) {
+      ExternalLinkage(ExternalLinkage), Name(namePoolOf(M).intern(Name)), Parent(M),
+      NumValueNumbers(NumArgs) {
     // check return type.
     assert(FunctionType::isValidReturnType(getReturnType()) &&
             "invalid return type");
     // build parameters and check parameter types.
     if (NumArgs > 0) {
-        Arguments = std::allocator<Argument>().allocate(NumArgs);
+        Arguments = static_cast<Argument *>(SlabAllocator::allocateOwned(allocatorOf(M),
+                                                                     NumArgs * sizeof(Argument)));
+        AllocStats::allocate(AllocKind::Argument, NumArgs * sizeof(Argument), NumArgs);
         for (unsigned i = 0, e = NumArgs; i != e; ++i) {
             Type *ArgTy = FTy->getParamType(i);
             assert(FunctionType::isValidArgumentType(ArgTy) && "Badly typed arguments!");
@@ -565,11 +818,20 @@ Function::Function(FunctionType *FTy, bool ExternalLinkage,
 }
 
 Function::~Function() {
+    // The blocks are freed one after another, so forget the edges between
+    // them before the terminators try to remove them.
+    for (BasicBlock &BB : *this) {
+        BB.Preds.clear();
+        for (Instruction &I : BB)
+            for (unsigned i = 0, e = I.getNumSuccessors(); i != e; ++i)
+                I.getSuccessorRef(i) = nullptr;
+    }
     if (NumArgs > 0) {
         for (unsigned i = 0, e = NumArgs; i != e; ++i) {
             Arguments[i].~Argument();
         }
-        std::allocator<Argument>().deallocate(Arguments, NumArgs);
+        SlabAllocator::deallocateOwned(Arguments, NumArgs * sizeof(Argument));
+        AllocStats::deallocate(AllocKind::Argument, NumArgs * sizeof(Argument), NumArgs);
         Arguments = nullptr;
     }
     // remove symbol table entry.
@@ -580,7 +842,7 @@ Function::~Function() {
 
 Function *Function::Create(FunctionType *FTy, bool ExternalLinkage, 
                            std::string_view Name, Module *M) {
-    return new Function(FTy, ExternalLinkage, Name, M);
+    return new (allocatorOf(M)) Function(FTy, ExternalLinkage, Name, M);
 }
 
 Function::iterator Function::insert(Function::iterator Position, BasicBlock *BB) {
@@ -593,6 +855,42 @@ bool Function::hasName() const {
     return !Name.empty();
 }
 
+unsigned Function::allocateValueNumber() {
+    if (FreeValueNumbers.empty())
+        return NumValueNumbers++;
+    unsigned Number = FreeValueNumbers.back();
+    FreeValueNumbers.pop_back();
+    return Number;
+}
+
+unsigned Function::allocateBlockNumber() {
+    if (FreeBlockNumbers.empty())
+        return NumBlockNumbers++;
+    unsigned Number = FreeBlockNumbers.back();
+    FreeBlockNumbers.pop_back();
+    return Number;
+}
+
+unsigned Function::getValueNumber(const Value *V) {
+    if (auto *Arg = dyn_cast<Argument>(V))
+        return Arg->getNumber();
+    assert(isa<Instruction>(V) && "Only arguments and instructions are numbered!");
+    return cast<Instruction>(V)->getNumber();
+}
+
+void Function::renumberValues() {
+    unsigned ValueNo = NumArgs, BlockNo = 0;
+    for (BasicBlock &BB : *this) {
+        BB.Number = BlockNo++;
+        for (Instruction &I : BB)
+            I.Number = ValueNo++;
+    }
+    NumValueNumbers = ValueNo;
+    NumBlockNumbers = BlockNo;
+    FreeValueNumbers.clear();
+    FreeBlockNumbers.clear();
+}
+
 GlobalVariable::GlobalVariable(Type *EleTy, std::size_t NumElements, bool ExternalLinkage,
                                std::string_view Name, Module *M)
     : Value(PointerType::get(EleTy), Value::GlobalVariableVal),
@@ -609,7 +907,7 @@ GlobalVariable::GlobalVariable(Type *EleTy, std::size_t NumElements, bool Extern
 
 GlobalVariable *GlobalVariable::Create(Type *EleTy, std::size_t NumElements, bool ExternalLinkage,
                                         std::string_view Name, Module *M) {
-    return new GlobalVariable(EleTy, NumElements, ExternalLinkage, Name, M);
+    return new (allocatorOf(M)) GlobalVariable(EleTy, NumElements, ExternalLinkage, Name, M);
 }
 
 
@@ -1,13 +1,48 @@
 #include "ir/type.h"
 #include "ir/ir.h"
 #include "utils/casting.h"
-#include <fmt/core.h>
+#include <fmt/format.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <iostream>
 #include <stdexcept>
 #include <ostream>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
 
+/// Output of the writer. Fragments are appended to a growable
+/// fmt::memory_buffer, there is no stream or virtual call per fragment.
+class IRBuffer {
+    fmt::memory_buffer Buf;
+public:
+    IRBuffer &operator<<(std::string_view S) {
+        Buf.append(S.data(), S.data() + S.size());
+        return *this;
+    }
+    IRBuffer &operator<<(char C) {
+        Buf.push_back(C);
+        return *this;
+    }
+    template <typename T, std::enable_if_t<std::is_integral_v<T>, int> = 0>
+    IRBuffer &operator<<(T N) {
+        fmt::format_int Str(N);
+        Buf.append(Str.data(), Str.data() + Str.size());
+        return *this;
+    }
+    IRBuffer &operator<<(const IRBuffer &Other) {
+        Buf.append(Other.Buf.data(), Other.Buf.data() + Other.Buf.size());
+        return *this;
+    }
+
+    void reserve(std::size_t Size) { Buf.reserve(Size); }
+    [[nodiscard]] std::size_t size() const { return Buf.size(); }
+    [[nodiscard]] const char *data() const { return Buf.data(); }
+};
+
 enum PrefixType {
     GlobalPrefix,
     ArgPrefix,
@@ -16,7 +51,7 @@ enum PrefixType {
 };
 
 /// Turn the specified name into an 'Accipit name', which is either prefixed with %
-static void PrintAccipitName(std::ostream &OS, std::string_view Name, PrefixType Prefix) {
+static void PrintAccipitName(IRBuffer &OS, std::string_view Name, PrefixType Prefix) {
     switch (Prefix) {
     case NoPrefix:
         break;
@@ -35,7 +70,7 @@ static void PrintAccipitName(std::ostream &OS, std::string_view Name, PrefixType
 }
 
 /// Turn the specified name into an 'Accipit name', which is either prefixed with %
-static void PrintAccipitName(std::ostream &OS, const Value *V) {
+static void PrintAccipitName(IRBuffer &OS, const Value *V) {
     PrintAccipitName(OS, V->getName(),
                 isa<GlobalVariable>(V) ? GlobalPrefix : isa<Argument>(V) ? ArgPrefix : LocalPrefix);
 }
@@ -62,13 +97,13 @@ namespace {
 
 class TypePrinter {
 public:
-    void print(Type *Ty, std::ostream &os);
+    void print(Type *Ty, IRBuffer &OS);
 };
 
 } // end of annoymous namespace
 
 
-void TypePrinter::print(Type *Ty, std::ostream &OS) {
+void TypePrinter::print(Type *Ty, IRBuffer &OS) {
     switch (Ty->getTypeID()) {
     case Type::IntegerTyID:
         OS << "i32";
@@ -105,10 +140,12 @@ class SlotTracker {
     std::unordered_map<Function *, unsigned> FunctionSlots;
     std::unordered_map<GlobalVariable *, unsigned> GlobalSlots;
     unsigned gNext = 0;
-    // Local scope slots, binding to a specific function.
-    Function *F;
-    std::unordered_map<BasicBlock *, unsigned> BasicBlockSlots;
-    std::unordered_map<Value *, unsigned> LocalSlots;
+    // Local scope slots, binding to a specific function. They are indexed
+    // by the value and block numbers of the function, NoSlot for the named.
+    static constexpr unsigned NoSlot = ~0u;
+    const Function *F = nullptr;
+    std::vector<unsigned> BasicBlockSlots;
+    std::vector<unsigned> LocalSlots;
     unsigned lNext = 0;
 
 public:
@@ -125,6 +162,8 @@ public:
 };
 
 SlotTracker::SlotTracker(const Module *M) : M(M) {
+    // The module level slots are only looked up for the rare unnamed
+    // globals and functions, so they are kept in maps.
     for (auto GI = M->global_begin(), GE = M->global_end(); GI != GE; ++GI) {
         if (!GI->hasName())
             GlobalSlots[&*GI] = gNext++;
@@ -138,23 +177,24 @@ SlotTracker::SlotTracker(const Module *M) : M(M) {
 
 
 void SlotTracker::incorporateFunction(const Function *F) {
-    // clear
-    this->F = const_cast<Function *>(F);
-    BasicBlockSlots.clear();
-    LocalSlots.clear();
+    if (this->F == F)
+        return;
+    this->F = F;
+    BasicBlockSlots.assign(F->getNumBlockNumbers(), NoSlot);
+    LocalSlots.assign(F->getNumValueNumbers(), NoSlot);
     lNext = 0;
     // assign slot number.
     for (auto Arg = F->arg_begin(), ArgE = F->arg_end(); Arg != ArgE; ++Arg) {
         if (!Arg->hasName()) {
-            LocalSlots[const_cast<Argument *>(Arg)] = lNext++;
+            LocalSlots[Arg->getNumber()] = lNext++;
         }
     }
     for (auto & BI : *F) {
         if (!BI.hasName())
-            BasicBlockSlots[&BI] = lNext++;
+            BasicBlockSlots[BI.getNumber()] = lNext++;
         for (auto & I : BI) {
             if (!I.hasName())
-                LocalSlots[&I] = lNext++;
+                LocalSlots[I.getNumber()] = lNext++;
         }
     }
 }
@@ -174,22 +214,32 @@ std::optional<unsigned> SlotTracker::getFunctionSlot(const Function *F) {
 }
 
 std::optional<unsigned> SlotTracker::getBasicBlockSlot(const BasicBlock *BB) {
-    auto It = BasicBlockSlots.find(const_cast<BasicBlock *>(BB));
-    if (It == BasicBlockSlots.end())
+    if (!F || BB->getParent() != F || BasicBlockSlots[BB->getNumber()] == NoSlot)
         return std::nullopt;
-    return It->second;
+    return BasicBlockSlots[BB->getNumber()];
 }
 
 std::optional<unsigned> SlotTracker::getLocalSlot(const Value *V) {
-    auto It = LocalSlots.find(const_cast<Value *>(V));
-    if (It == LocalSlots.end())
+    unsigned Number;
+    if (auto *Arg = dyn_cast<Argument>(V)) {
+        if (Arg->getParent() != F)
+            return std::nullopt;
+        Number = Arg->getNumber();
+    } else if (auto *I = dyn_cast<Instruction>(V)) {
+        if (!F || !I->getParent() || I->getParent()->getParent() != F)
+            return std::nullopt;
+        Number = I->getNumber();
+    } else {
         return std::nullopt;
-    return It->second;
+    }
+    if (LocalSlots[Number] == NoSlot)
+        return std::nullopt;
+    return LocalSlots[Number];
 }
 
 
 
-static void WriteConstantInternal(std::ostream &Out, const Constant *C,
+static void WriteConstantInternal(IRBuffer &Out, const Constant *C,
                                   SlotTracker &Tracker, bool isForDebug) {
     if (const auto *CI = dyn_cast<ConstantInt>(C)) {
         Out << CI->getValue();
@@ -205,7 +255,7 @@ static void WriteConstantInternal(std::ostream &Out, const Constant *C,
 
 // Full implementation of printing a Value as an operand with support for
 // TypePrinting, etc.
-static void WriteAsOperandInternal(std::ostream &Out, const Value *V,
+static void WriteAsOperandInternal(IRBuffer &Out, const Value *V,
                                    SlotTracker &Tracker, bool isForDebug) {
     if (V->hasName()) {
         PrintAccipitName(Out, V);
@@ -243,7 +293,7 @@ static void WriteAsOperandInternal(std::ostream &Out, const Value *V,
     }
 }
 
-static void WriteFunctionOperandInternal(std::ostream &Out, const Function *F,
+static void WriteFunctionOperandInternal(IRBuffer &Out, const Function *F,
                                         SlotTracker &Tracker, bool isForDebug) {
     if (F->hasName()) {
         PrintAccipitName(Out, F->getName(), GlobalPrefix);
@@ -257,7 +307,7 @@ static void WriteFunctionOperandInternal(std::ostream &Out, const Function *F,
     }
 }
 
-static void WriteBasicBlockOperandInternal(std::ostream &Out, const BasicBlock *BB,
+static void WriteBasicBlockOperandInternal(IRBuffer &Out, const BasicBlock *BB,
                                           SlotTracker &Tracker, bool isForDebug) {
     if (BB->hasName()) {
         PrintAccipitName(Out, BB->getName(), LocalPrefix);
@@ -273,11 +323,11 @@ static void WriteBasicBlockOperandInternal(std::ostream &Out, const BasicBlock *
 
 /// Print the Accipit IR to text form.
 class AccipitWriter {
-    std::ostream &Out;
+    IRBuffer &Out;
     SlotTracker &Tracker;
     bool isForDebug;
 public:
-    AccipitWriter(std::ostream &OS, SlotTracker &Tracker, bool isForDebug)
+    AccipitWriter(IRBuffer &OS, SlotTracker &Tracker, bool isForDebug)
         : Out(OS), Tracker(Tracker), isForDebug(isForDebug) { }
 
     void printInstruction(const Instruction *I);
@@ -518,8 +568,60 @@ void AccipitWriter::printModule(const Module *M) {
     }
 }
 
-void Module::print(std::ostream &OS, bool isForDebug) const {
-    SlotTracker Tracker(this);
-    AccipitWriter Writer(OS, Tracker, isForDebug);
-    Writer.printModule(this);
+/// Print M into Out. With NumThreads > 1 the functions are formatted by
+/// several threads, each into a buffer of its own with its own copy of the
+/// module level slots, and the buffers are joined in module order.
+static void printModuleBuffer(IRBuffer &Out, const Module *M, bool isForDebug, unsigned NumThreads) {
+    SlotTracker Tracker(M);
+    std::vector<const Function *> Functions;
+    for (auto & FI : *M)
+        Functions.push_back(&FI);
+    NumThreads = std::min<std::size_t>(NumThreads, Functions.size());
+    if (NumThreads <= 1) {
+        AccipitWriter(Out, Tracker, isForDebug).printModule(M);
+        return;
+    }
+
+    AccipitWriter Writer(Out, Tracker, isForDebug);
+    for (auto GI = M->global_begin(), GE = M->global_end(); GI != GE; ++GI)
+        Writer.printGlobalVariable(&*GI);
+
+    std::vector<IRBuffer> Buffers(Functions.size());
+    std::atomic<std::size_t> Next{0};
+    auto Worker = [&]() {
+        SlotTracker LocalTracker(Tracker);
+        for (std::size_t i = Next++; i < Functions.size(); i = Next++)
+            AccipitWriter(Buffers[i], LocalTracker, isForDebug).printFunction(Functions[i]);
+    };
+    std::vector<std::thread> Threads;
+    for (unsigned i = 1; i < NumThreads; ++i)
+        Threads.emplace_back(Worker);
+    Worker();
+    for (auto &T : Threads)
+        T.join();
+
+    std::size_t Size = Out.size();
+    for (auto &B : Buffers)
+        Size += B.size();
+    Out.reserve(Size);
+    for (auto &B : Buffers)
+        Out << B;
+}
+
+void Module::print(std::ostream &OS, bool isForDebug, unsigned NumThreads) const {
+    IRBuffer Out;
+    printModuleBuffer(Out, this, isForDebug, NumThreads);
+    OS.write(Out.data(), Out.size());
+}
+
+bool Module::printToFile(const std::string &Path, bool isForDebug, unsigned NumThreads) const {
+    IRBuffer Out;
+    printModuleBuffer(Out, this, isForDebug, NumThreads);
+    std::FILE *File = std::fopen(Path.c_str(), "wb");
+    if (!File)
+        return false;
+    // unbuffered, so the whole text goes out in a single write
+    std::setvbuf(File, nullptr, _IONBF, 0);
+    bool Ok = std::fwrite(Out.data(), 1, Out.size(), File) == Out.size();
+    return std::fclose(File) == 0 && Ok;
 }
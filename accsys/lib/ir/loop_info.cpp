@@ -0,0 +1,188 @@
+#include "ir/loop_info.h"
+#include "utils/bit_vector.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+/// Push BB to Blocks unless it is there already.
+void addUnique(std::vector<BasicBlock *> &Blocks, BasicBlock *BB) {
+    if (std::find(Blocks.begin(), Blocks.end(), BB) == Blocks.end())
+        Blocks.push_back(BB);
+}
+
+/// Return the only block of Blocks, null if there are none or several.
+BasicBlock *getSingle(const std::vector<BasicBlock *> &Blocks) {
+    return Blocks.size() == 1 ? Blocks.front() : nullptr;
+}
+
+} // namespace
+
+std::vector<BasicBlock *> Loop::getLoopLatches() const {
+    std::vector<BasicBlock *> Latches;
+    for (BasicBlock *Pred : getHeader()->predecessors())
+        if (contains(Pred))
+            addUnique(Latches, Pred);
+    return Latches;
+}
+
+BasicBlock *Loop::getLoopLatch() const { return getSingle(getLoopLatches()); }
+
+std::vector<BasicBlock *> Loop::getExitingBlocks() const {
+    std::vector<BasicBlock *> Exiting;
+    for (BasicBlock *BB : Blocks) {
+        for (BasicBlock *Succ : BB->successors()) {
+            if (Succ && !contains(Succ)) {
+                Exiting.push_back(BB);
+                break;
+            }
+        }
+    }
+    return Exiting;
+}
+
+BasicBlock *Loop::getExitingBlock() const { return getSingle(getExitingBlocks()); }
+
+std::vector<BasicBlock *> Loop::getExitBlocks() const {
+    std::vector<BasicBlock *> Exits;
+    for (BasicBlock *BB : Blocks)
+        for (BasicBlock *Succ : BB->successors())
+            if (Succ && !contains(Succ))
+                addUnique(Exits, Succ);
+    return Exits;
+}
+
+BasicBlock *Loop::getExitBlock() const { return getSingle(getExitBlocks()); }
+
+BasicBlock *Loop::getLoopPredecessor() const {
+    BasicBlock *Out = nullptr;
+    for (BasicBlock *Pred : getHeader()->predecessors()) {
+        if (contains(Pred))
+            continue;
+        if (Out && Out != Pred)
+            return nullptr;
+        Out = Pred;
+    }
+    return Out;
+}
+
+BasicBlock *Loop::getLoopPreheader() const {
+    BasicBlock *Pred = getLoopPredecessor();
+    return Pred && Pred->getSingleSuccessor() == getHeader() ? Pred : nullptr;
+}
+
+void LoopInfo::releaseMemory() {
+    AllLoops.clear();
+    TopLevelLoops.clear();
+    BBMap.clear();
+    Parent = nullptr;
+}
+
+// Walk the reverse CFG from the back edges of L to its header, mapping the
+// blocks found to L. Loops found on the way, which are nested in L as
+// their headers were visited first, become subloops of L and are skipped
+// over to their header.
+void LoopInfo::discoverAndMapSubloop(Loop *L, std::vector<BasicBlock *> &Backedges,
+                                     const DominatorTree &DT) {
+    std::vector<BasicBlock *> &Worklist = Backedges;
+    while (!Worklist.empty()) {
+        BasicBlock *PredBB = Worklist.back();
+        Worklist.pop_back();
+        Loop *Subloop = BBMap[PredBB];
+        if (!Subloop) {
+            if (!DT.isReachableFromEntry(PredBB))
+                continue;
+            BBMap[PredBB] = L;
+            if (PredBB == L->getHeader())
+                continue;
+            for (BasicBlock *Pred : PredBB->predecessors())
+                Worklist.push_back(Pred);
+            continue;
+        }
+        while (Subloop->ParentLoop)
+            Subloop = Subloop->ParentLoop;
+        if (Subloop == L)
+            continue;
+        Subloop->ParentLoop = L;
+        for (BasicBlock *Pred : Subloop->getHeader()->predecessors())
+            if (BBMap[Pred] != Subloop)
+                Worklist.push_back(Pred);
+    }
+}
+
+void LoopInfo::analyze(const DominatorTree &DT) {
+    releaseMemory();
+    Parent = DT.getParent();
+    DomTreeNode *Root = DT.getRootNode();
+    if (!Root)
+        return;
+    BBMap.grow(Parent->getNumBlockNumbers() - 1);
+
+    // Headers in postorder of the dominator tree, so inner loops are found
+    // before the loops around them.
+    std::vector<std::pair<DomTreeNode *, DomTreeNode::const_iterator>> DomStack {{Root, Root->begin()}};
+    std::vector<BasicBlock *> Backedges;
+    while (!DomStack.empty()) {
+        auto &[N, NextChild] = DomStack.back();
+        if (NextChild != N->end()) {
+            DomTreeNode *Child = *NextChild++;
+            DomStack.push_back({Child, Child->begin()});
+            continue;
+        }
+        BasicBlock *Header = N->getBlock();
+        DomStack.pop_back();
+        for (BasicBlock *Pred : Header->predecessors())
+            if (DT.isReachableFromEntry(Pred) && DT.dominates(Header, Pred))
+                Backedges.push_back(Pred);
+        if (Backedges.empty())
+            continue;
+        AllLoops.push_back(std::unique_ptr<Loop>(new Loop(Header)));
+        discoverAndMapSubloop(AllLoops.back().get(), Backedges, DT);
+    }
+
+    // Fill the blocks and subloops in postorder of the CFG, then reverse
+    // them. A loop is complete when its header is reached, as the header
+    // comes last in postorder.
+    BitVector Visited(Parent->getNumBlockNumbers());
+    BasicBlock *Entry = Root->getBlock();
+    Visited.set(Entry->getNumber());
+    std::vector<std::pair<BasicBlock *, BasicBlock::succ_iterator>> CFGStack {{Entry, Entry->succ_begin()}};
+    while (!CFGStack.empty()) {
+        auto &[BB, NextSucc] = CFGStack.back();
+        if (NextSucc != BB->succ_end()) {
+            BasicBlock *Succ = *NextSucc++;
+            if (Succ && !Visited.test_and_set(Succ->getNumber()))
+                CFGStack.push_back({Succ, Succ->succ_begin()});
+            continue;
+        }
+        BasicBlock *Block = BB;
+        CFGStack.pop_back();
+        Loop *Subloop = BBMap[Block];
+        if (Subloop && Subloop->getHeader() == Block) {
+            if (Subloop->ParentLoop)
+                Subloop->ParentLoop->SubLoops.push_back(Subloop);
+            else
+                TopLevelLoops.push_back(Subloop);
+            std::reverse(Subloop->Blocks.begin() + 1, Subloop->Blocks.end());
+            std::reverse(Subloop->SubLoops.begin(), Subloop->SubLoops.end());
+            Subloop = Subloop->ParentLoop;
+        }
+        for (; Subloop; Subloop = Subloop->ParentLoop)
+            Subloop->addBlockEntry(Block);
+    }
+    std::reverse(TopLevelLoops.begin(), TopLevelLoops.end());
+}
+
+std::vector<Loop *> LoopInfo::getLoopsInPreorder() const {
+    std::vector<Loop *> Preorder;
+    Preorder.reserve(AllLoops.size());
+    std::vector<Loop *> Stack(TopLevelLoops.rbegin(), TopLevelLoops.rend());
+    while (!Stack.empty()) {
+        Loop *L = Stack.back();
+        Stack.pop_back();
+        Preorder.push_back(L);
+        Stack.insert(Stack.end(), L->SubLoops.rbegin(), L->SubLoops.rend());
+    }
+    return Preorder;
+}
@@ -0,0 +1,69 @@
+#include "utils/slab_allocator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+static_assert(SlabAllocator::OwnerSize % SlabAllocator::Alignment == 0,
+              "owner prefix breaks the alignment of the block");
+
+SlabAllocator::~SlabAllocator() {
+    for (void *Slab : Slabs)
+        ::operator delete(Slab);
+}
+
+void SlabAllocator::startNewSlab(std::size_t MinSize) {
+    // Slabs double every 16 slabs, up to 4 MB, so large modules do not
+    // end up with thousands of them.
+    std::size_t SlabSize = InitialSlabSize << std::min<std::size_t>(Slabs.size() / 16, 8);
+    SlabSize = std::max(SlabSize, MinSize);
+    CurPtr = static_cast<char *>(::operator new(SlabSize));
+    End = CurPtr + SlabSize;
+    Slabs.push_back(CurPtr);
+    TotalMemory += SlabSize;
+}
+
+void *SlabAllocator::allocate(std::size_t Size) {
+    assert(Size > 0 && Size <= MaxBlockSize && "Block size out of range!");
+    std::size_t Class = getSizeClass(Size);
+    if (FreeBlock *Block = FreeLists[Class]) {
+        FreeLists[Class] = Block->Next;
+        return Block;
+    }
+    std::size_t Rounded = (Class + 1) * Alignment;
+    if (static_cast<std::size_t>(End - CurPtr) < Rounded)
+        startNewSlab(Rounded);
+    void *Ptr = CurPtr;
+    CurPtr += Rounded;
+    return Ptr;
+}
+
+void SlabAllocator::deallocate(void *Ptr, std::size_t Size) {
+    assert(Size > 0 && Size <= MaxBlockSize && "Block size out of range!");
+    static_assert(sizeof(FreeBlock) <= Alignment, "free block does not fit the smallest class");
+    std::size_t Class = getSizeClass(Size);
+    auto *Block = new (Ptr) FreeBlock {FreeLists[Class]};
+    FreeLists[Class] = Block;
+}
+
+void *SlabAllocator::allocateOwned(SlabAllocator *A, std::size_t Size, std::size_t Prefix) {
+    assert(Prefix % Alignment == 0 && "prefix breaks the alignment of the block");
+    std::size_t Total = Prefix + OwnerSize + Size;
+    if (A && Total > MaxBlockSize)
+        A = nullptr;
+    void *Block = A ? A->allocate(Total) : ::operator new(Total);
+    auto **Owner = reinterpret_cast<SlabAllocator **>(static_cast<char *>(Block) + Prefix);
+    *Owner = A;
+    return Owner + 1;
+}
+
+void SlabAllocator::deallocateOwned(void *Ptr, std::size_t Size, std::size_t Prefix) {
+    if (!Ptr)
+        return;
+    SlabAllocator *A = getOwner(Ptr);
+    char *Block = static_cast<char *>(Ptr) - OwnerSize - Prefix;
+    if (A)
+        A->deallocate(Block, Prefix + OwnerSize + Size);
+    else
+        ::operator delete(Block);
+}
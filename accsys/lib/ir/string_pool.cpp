@@ -0,0 +1,41 @@
+#include "utils/string_pool.h"
+#include "utils/alloc_stats.h"
+
+#include <cassert>
+#include <limits>
+#include <new>
+
+StringPool::~StringPool() {
+    for (char *Chunk : Chunks)
+        ::operator delete(Chunk);
+    AllocStats::deallocate(AllocKind::Name, getTotalMemory(), Chunks.size());
+}
+
+InternedString StringPool::intern(std::string_view Str) {
+    if (Str.empty())
+        return {};
+    auto IT = Strings.find(Str);
+    if (IT != Strings.end())
+        return InternedString(IT->data());
+
+    assert(Str.size() <= std::numeric_limits<std::uint32_t>::max() && "Name too long!");
+    std::uint32_t Length = Str.size();
+    // length, characters and a terminating null, keeping the next length aligned
+    std::size_t Need = (sizeof(Length) + Str.size() + 1 + alignof(std::uint32_t) - 1) &
+                       ~(alignof(std::uint32_t) - 1);
+    if (static_cast<std::size_t>(End - CurPtr) < Need) {
+        std::size_t Size = Need > ChunkSize ? Need : ChunkSize;
+        CurPtr = static_cast<char *>(::operator new(Size));
+        End = CurPtr + Size;
+        Chunks.push_back(CurPtr);
+        TotalMemory += Size;
+        AllocStats::allocate(AllocKind::Name, Size);
+    }
+    std::memcpy(CurPtr, &Length, sizeof(Length));
+    char *Data = CurPtr + sizeof(Length);
+    std::memcpy(Data, Str.data(), Str.size());
+    Data[Str.size()] = '\0';
+    CurPtr += Need;
+    Strings.insert(std::string_view(Data, Str.size()));
+    return InternedString(Data);
+}
@@ -5,8 +5,7 @@
 
 Type Type::IntegerTy(Type::IntegerTyID);
 Type Type::UnitTy(Type::UnitTyID);
-thread_local unsigned Type::FunctionTypeHandle = 0;
-thread_local Buffer<unsigned, FunctionType> Type::FunctionTypes;
+thread_local Buffer<FunctionTypeKey, FunctionType, FunctionTypeKey::Hash> Type::FunctionTypes;
 thread_local Buffer<Type *, PointerType> Type::PointerTypes;
 
 Type *Type::getIntegerTy() {
@@ -55,10 +54,13 @@ FunctionType::FunctionType(Type *Result, const std::vector<Type *> &Params)
     : Type(Type::FunctionTyID), Params(Params), Result(Result) { }
 
 FunctionType *FunctionType::get(Type *Result, const std::vector<Type *> &Params) {
-    auto Insertion = Type::FunctionTypes.insert_as(Type::FunctionTypeHandle++);
+    if (FunctionType *FTy = Type::FunctionTypes.lookup(FunctionTypeKey(Result, Params)))
+        return FTy;
 
-    FunctionType *FTy = Insertion.first->second;
+    FunctionType *FTy = Type::FunctionTypes.allocate();
     new (FTy) FunctionType(Result, Params);
+    // The stored key views the parameters of the new type, not the caller's.
+    Type::FunctionTypes.insert(FunctionTypeKey(Result, FTy->Params), FTy);
     return FTy;
 }
 
@@ -0,0 +1,223 @@
+#include "ir/ir.h"
+#include "ir/dominators.h"
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+
+namespace {
+
+// entry -> cond; cond -> body | exit; body -> then | latch; then -> latch;
+// latch -> cond; plus a block nothing branches to.
+struct LoopFunction {
+    Module M;
+    Function *F;
+    BasicBlock *Entry, *Cond, *Body, *Then, *Latch, *Exit, *Dead;
+
+    LoopFunction() {
+        Type *IntegerType = Type::getIntegerTy();
+        F = Function::Create(FunctionType::get(IntegerType, {IntegerType}), false, "f", &M);
+        Entry = BasicBlock::Create(F);
+        Cond = BasicBlock::Create(F);
+        Body = BasicBlock::Create(F);
+        Then = BasicBlock::Create(F);
+        Latch = BasicBlock::Create(F);
+        Exit = BasicBlock::Create(F);
+        Dead = BasicBlock::Create(F);
+        Value *N = F->getArg(0);
+        JumpInst::Create(Cond, Entry);
+        BranchInst::Create(Body, Exit, N, Cond);
+        BranchInst::Create(Then, Latch, N, Body);
+        JumpInst::Create(Latch, Then);
+        JumpInst::Create(Cond, Latch);
+        RetInst::Create(N, Exit);
+        JumpInst::Create(Exit, Dead);
+    }
+};
+
+} // namespace
+
+TEST(DominatorTreeTest, DominatorTest) {
+    LoopFunction L;
+    DominatorTree DT(*L.F);
+    ASSERT_EQ(DT.getRootNode()->getBlock(), L.Entry);
+    ASSERT_EQ(DT.getIDom(L.Entry), nullptr);
+    ASSERT_EQ(DT.getIDom(L.Cond), L.Entry);
+    ASSERT_EQ(DT.getIDom(L.Body), L.Cond);
+    ASSERT_EQ(DT.getIDom(L.Then), L.Body);
+    ASSERT_EQ(DT.getIDom(L.Latch), L.Body);
+    ASSERT_EQ(DT.getIDom(L.Exit), L.Cond);
+    ASSERT_EQ(DT.getNode(L.Latch)->getLevel(), 3u);
+    ASSERT_EQ(DT.getNode(L.Body)->getNumChildren(), 2u);
+
+    ASSERT_TRUE(DT.dominates(L.Cond, L.Latch));
+    ASSERT_TRUE(DT.dominates(L.Latch, L.Latch));
+    ASSERT_FALSE(DT.properlyDominates(L.Latch, L.Latch));
+    ASSERT_FALSE(DT.dominates(L.Then, L.Latch));
+    ASSERT_FALSE(DT.dominates(L.Body, L.Exit));
+    ASSERT_EQ(DT.findNearestCommonDominator(L.Then, L.Exit), L.Cond);
+    ASSERT_EQ(DT.findNearestCommonDominator(L.Then, L.Latch), L.Body);
+
+    // Unreachable blocks are not in the tree, and dominated by everything.
+    ASSERT_FALSE(DT.isReachableFromEntry(L.Dead));
+    ASSERT_TRUE(DT.dominates(L.Exit, L.Dead));
+    ASSERT_FALSE(DT.dominates(L.Dead, L.Exit));
+
+    DT.updateDFSNumbers();
+    ASSERT_TRUE(DT.getNode(L.Then)->dominatedBy(DT.getNode(L.Cond)));
+    ASSERT_FALSE(DT.getNode(L.Exit)->dominatedBy(DT.getNode(L.Body)));
+
+    // Within a block, the earlier instruction dominates.
+    Instruction *Jump = L.Entry->getTerminator();
+    AllocaInst *Addr = AllocaInst::Create(Type::getIntegerTy(), 1, Jump);
+    ASSERT_TRUE(DT.dominates(Addr, Jump));
+    ASSERT_FALSE(DT.dominates(Jump, Addr));
+    ASSERT_TRUE(DT.dominates(Addr, L.Latch->getTerminator()));
+    ASSERT_TRUE(DT.verify());
+}
+
+TEST(DominatorTreeTest, PostDominatorTest) {
+    LoopFunction L;
+    PostDominatorTree PDT(*L.F);
+    ASSERT_EQ(PDT.getRoots(), std::vector<BasicBlock *> {L.Exit});
+    ASSERT_EQ(PDT.getRootNode()->getBlock(), nullptr);
+    ASSERT_EQ(PDT.getIDom(L.Exit), nullptr);
+    ASSERT_EQ(PDT.getIDom(L.Cond), L.Exit);
+    ASSERT_EQ(PDT.getIDom(L.Body), L.Latch);
+    ASSERT_EQ(PDT.getIDom(L.Then), L.Latch);
+    ASSERT_EQ(PDT.getIDom(L.Latch), L.Cond);
+    ASSERT_EQ(PDT.getIDom(L.Entry), L.Cond);
+    ASSERT_EQ(PDT.getIDom(L.Dead), L.Exit);
+    ASSERT_TRUE(PDT.dominates(L.Cond, L.Body));
+    ASSERT_FALSE(PDT.dominates(L.Then, L.Body));
+    Instruction *Ret = L.Exit->getTerminator();
+    ASSERT_TRUE(PDT.dominates(Ret, L.Entry->getTerminator()));
+
+    // An infinite loop gets a root of its own.
+    L.Latch->getTerminator()->eraseFromParent();
+    JumpInst::Create(L.Body, L.Latch);
+    PDT.recalculate(*L.F);
+    ASSERT_EQ(PDT.getRoots(), (std::vector<BasicBlock *> {L.Exit, L.Body}));
+    ASSERT_EQ(PDT.getIDom(L.Latch), L.Body);
+    ASSERT_EQ(PDT.getIDom(L.Body), nullptr);
+    ASSERT_TRUE(PDT.verify());
+}
+
+TEST(DominatorTreeTest, DominanceFrontierTest) {
+    LoopFunction L;
+    DominatorTree DT(*L.F);
+    DominanceFrontier DF(DT);
+    using Blocks = std::vector<BasicBlock *>;
+    ASSERT_EQ(DF.getFrontier(L.Entry), Blocks {});
+    ASSERT_EQ(DF.getFrontier(L.Cond), Blocks {L.Cond});
+    ASSERT_EQ(DF.getFrontier(L.Then), Blocks {L.Latch});
+    ASSERT_EQ(DF.getFrontier(L.Latch), Blocks {L.Cond});
+    ASSERT_EQ(DF.getFrontier(L.Body), Blocks {L.Cond});
+    ASSERT_EQ(DF.getFrontier(L.Exit), Blocks {});
+
+    // The body and its branch are control dependent on the loop condition.
+    PostDominatorTree PDT(*L.F);
+    PostDominanceFrontier PDF(PDT);
+    ASSERT_EQ(PDF.getFrontier(L.Body), Blocks {L.Cond});
+    ASSERT_EQ(PDF.getFrontier(L.Then), Blocks {L.Body});
+    ASSERT_EQ(PDF.getFrontier(L.Cond), Blocks {L.Cond});
+    ASSERT_EQ(PDF.getFrontier(L.Latch), Blocks {L.Cond});
+    ASSERT_EQ(PDF.getFrontier(L.Exit), Blocks {});
+}
+
+TEST(DominatorTreeTest, RetargetTest) {
+    // entry -> p | q; p -> z | t; q -> r. Retargeting p -> t to p -> r
+    // rebuilds the subtree of p while the edge to r, which is deeper than
+    // p, is already in the CFG.
+    Type *IntegerType = Type::getIntegerTy();
+    Module M;
+    Function *F = Function::Create(FunctionType::get(IntegerType, {IntegerType}), false, "f", &M);
+    Value *C = F->getArg(0);
+    BasicBlock *Entry = BasicBlock::Create(F);
+    BasicBlock *P = BasicBlock::Create(F);
+    BasicBlock *Q = BasicBlock::Create(F);
+    BasicBlock *Z = BasicBlock::Create(F);
+    BasicBlock *T = BasicBlock::Create(F);
+    BasicBlock *R = BasicBlock::Create(F);
+    BranchInst::Create(P, Q, C, Entry);
+    BranchInst *Br = BranchInst::Create(Z, T, C, P);
+    JumpInst::Create(R, Q);
+    RetInst::Create(C, Z);
+    RetInst::Create(C, T);
+    RetInst::Create(C, R);
+    DominatorTree DT(*F);
+    Br->setFalseBB(R);
+    DT.deleteEdge(P, T);
+    DT.insertEdge(P, R);
+    ASSERT_EQ(DT.getIDom(R), Entry);
+    ASSERT_FALSE(DT.isReachableFromEntry(T));
+    ASSERT_TRUE(DT.verify());
+}
+
+TEST(DominatorTreeTest, UpdateTest) {
+    // Change the terminators of a random CFG an edge or a retarget at a
+    // time, the updated trees must match the ones built from scratch.
+    Type *IntegerType = Type::getIntegerTy();
+    Module M;
+    Function *F = Function::Create(FunctionType::get(IntegerType, {IntegerType}), false, "f", &M);
+    Value *C = F->getArg(0);
+    constexpr unsigned NumBlocks = 12;
+    std::vector<BasicBlock *> BBs;
+    for (unsigned i = 0; i != NumBlocks; ++i)
+        BBs.push_back(BasicBlock::Create(F));
+    std::mt19937 Rand(42);
+    auto Pick = [&] { return BBs[Rand() % NumBlocks]; };
+    for (BasicBlock *BB : BBs) {
+        if (Rand() % 4 == 0)
+            RetInst::Create(C, BB);
+        else
+            JumpInst::Create(Pick(), BB);
+    }
+
+    DominatorTree DT(*F);
+    PostDominatorTree PDT(*F);
+    for (unsigned Step = 0; Step != 400; ++Step) {
+        BasicBlock *BB = Pick();
+        Instruction *Term = BB->getTerminator();
+        BasicBlock *Inserted = nullptr, *Deleted = nullptr;
+        if (auto *Jump = dyn_cast<JumpInst>(Term)) {
+            BasicBlock *Dest = Jump->getDestBasicBlock();
+            Jump->eraseFromParent();
+            if (Rand() % 3 == 0) {
+                RetInst::Create(C, BB);
+                Deleted = Dest;
+            } else {
+                Inserted = Pick();
+                BranchInst::Create(Dest, Inserted, C, BB);
+            }
+        } else if (auto *Br = dyn_cast<BranchInst>(Term)) {
+            BasicBlock *True = Br->getTrueBB();
+            Deleted = Br->getFalseBB();
+            if (Rand() % 2 == 0) {
+                Inserted = Pick();
+                Br->setFalseBB(Inserted);
+            } else {
+                Br->eraseFromParent();
+                JumpInst::Create(True, BB);
+            }
+        } else {
+            Term->eraseFromParent();
+            Inserted = Pick();
+            JumpInst::Create(Inserted, BB);
+        }
+        if (Deleted) {
+            DT.deleteEdge(BB, Deleted);
+            PDT.deleteEdge(BB, Deleted);
+        }
+        if (Inserted) {
+            DT.insertEdge(BB, Inserted);
+            PDT.insertEdge(BB, Inserted);
+        }
+        ASSERT_TRUE(DT.verify()) << "step " << Step;
+        ASSERT_TRUE(PDT.verify()) << "step " << Step;
+        // Queries right after an update walk the tree.
+        BasicBlock *A = Pick(), *B = Pick();
+        ASSERT_EQ(DT.dominates(A, B), DominatorTree(*F).dominates(A, B));
+    }
+}
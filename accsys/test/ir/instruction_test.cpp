@@ -5,6 +5,8 @@
 #include "gtest/gtest.h"
 #include <cstddef>
 #include <optional>
+#include <memory>
+#include <string>
 #include <vector>
 
 
@@ -414,4 +416,209 @@ TEST(InstructionTest, BranchTest) {
     delete F;
     delete V1;
     delete V2;
-}
\ No newline at end of file
+}
+TEST(InstructionTest, ConstantPoolTest) {
+    // Constants are uniqued by value
+    ConstantInt *C1 = ConstantInt::Create(42);
+    ASSERT_EQ(ConstantInt::Create(42), C1);
+    ASSERT_NE(ConstantInt::Create(43), C1);
+    ASSERT_EQ(ConstantUnit::Create(), ConstantUnit::Create());
+    AllocCounter Consts = AllocStats::get(AllocKind::ConstantInt);
+    for (int i = 0; i < 100; ++i)
+        ConstantInt::Create(42);
+    ASSERT_EQ(AllocStats::get(AllocKind::ConstantInt).Objects, Consts.Objects);
+    // Deleting one by hand drops it from the pool
+    delete C1;
+    ConstantInt *C2 = ConstantInt::Create(42);
+    ASSERT_EQ(C2->getValue(), 42);
+    ASSERT_EQ(ConstantInt::Create(42), C2);
+    delete C2;
+}
+
+TEST(InstructionTest, AllocStatsTest) {
+    // Live counters follow creation and deletion
+    Type *IntegerType = Type::getIntegerTy();
+    AllocCounter Insts = AllocStats::get(AllocKind::Instruction);
+    AllocCounter Uses = AllocStats::get(AllocKind::Use);
+    AllocCounter Consts = AllocStats::get(AllocKind::ConstantInt);
+    Value *V1 = ConstantInt::Create(1);
+    Value *V2 = ConstantInt::Create(2);
+    BinaryInst *Add = BinaryInst::CreateAdd(V1, V2, IntegerType, (Instruction *)nullptr);
+    ASSERT_EQ(AllocStats::get(AllocKind::ConstantInt).Objects, Consts.Objects + 2);
+    ASSERT_EQ(AllocStats::get(AllocKind::ConstantInt).Bytes, Consts.Bytes + 2 * sizeof(ConstantInt));
+    ASSERT_EQ(AllocStats::get(AllocKind::Instruction).Objects, Insts.Objects + 1);
+    ASSERT_EQ(AllocStats::get(AllocKind::Instruction).Bytes, Insts.Bytes + sizeof(BinaryInst));
+    ASSERT_EQ(AllocStats::get(AllocKind::Use).Objects, Uses.Objects + 2);
+    delete Add;
+    delete V1;
+    delete V2;
+    ASSERT_EQ(AllocStats::get(AllocKind::Instruction).Bytes, Insts.Bytes);
+    ASSERT_EQ(AllocStats::get(AllocKind::Use).Bytes, Uses.Bytes);
+    ASSERT_EQ(AllocStats::get(AllocKind::ConstantInt).Objects, Consts.Objects);
+}
+
+TEST(InstructionTest, SlabAllocTest) {
+    // Instructions created into a module live in its slabs,
+    // erased ones are reused, detached ones stay on the heap.
+    Type *IntegerType = Type::getIntegerTy();
+    auto M = std::make_unique<Module>();
+    Function *F = Function::Create(FunctionType::get(IntegerType, {IntegerType}), false, "f", M.get());
+    BasicBlock *BB = BasicBlock::Create(F);
+    ASSERT_EQ(SlabAllocator::getOwner(F), &M->getAllocator());
+    ASSERT_EQ(SlabAllocator::getOwner(BB), &M->getAllocator());
+    ASSERT_EQ(SlabAllocator::getOwner(F->arg_begin()), &M->getAllocator());
+    AllocaInst *Addr = AllocaInst::Create(IntegerType, 1, BB);
+    StoreInst *Store = StoreInst::Create(F->getArg(0), Addr, BB);
+    ASSERT_EQ(SlabAllocator::getOwner(Addr), &M->getAllocator());
+    // The operands are allocated right in front of the instruction.
+    ASSERT_EQ(reinterpret_cast<const char *>(Store) - reinterpret_cast<const char *>(Store->op_end()),
+              static_cast<std::ptrdiff_t>(sizeof(std::size_t) + SlabAllocator::OwnerSize));
+    std::size_t Slabs = M->getAllocator().getNumSlabs();
+    Store->eraseFromParent();
+    StoreInst *Reused = StoreInst::Create(F->getArg(0), Addr, BB);
+    ASSERT_EQ(static_cast<void *>(Reused), static_cast<void *>(Store));
+    ASSERT_EQ(M->getAllocator().getNumSlabs(), Slabs);
+    LoadInst *Detached = LoadInst::Create(Addr);
+    ASSERT_EQ(SlabAllocator::getOwner(Detached), nullptr);
+    Detached->insertBefore(Reused);
+    ASSERT_EQ(&BB->front(), Addr);
+    RetInst::Create(Detached, BB);
+}
+
+TEST(InstructionTest, ComesBeforeTest) {
+    Type *IntegerType = Type::getIntegerTy();
+    auto M = std::make_unique<Module>();
+    Function *F = Function::Create(FunctionType::get(IntegerType, {}), false, "f", M.get());
+    BasicBlock *BB = BasicBlock::Create(F);
+    AllocaInst *Addr = AllocaInst::Create(IntegerType, 1, BB);
+    LoadInst *Load = LoadInst::Create(Addr, BB);
+    RetInst *Ret = RetInst::Create(Load, BB);
+    // Appending keeps the order.
+    ASSERT_TRUE(BB->isInstrOrderValid());
+    ASSERT_TRUE(Addr->comesBefore(Load));
+    ASSERT_TRUE(Load->comesBefore(Ret));
+    ASSERT_FALSE(Ret->comesBefore(Addr));
+    // Inserting in the middle renumbers on the next query.
+    StoreInst *Store = StoreInst::Create(ConstantInt::Create(1), Addr, Load);
+    ASSERT_FALSE(BB->isInstrOrderValid());
+    ASSERT_TRUE(Store->comesBefore(Load));
+    ASSERT_TRUE(Addr->comesBefore(Store));
+    ASSERT_TRUE(BB->isInstrOrderValid());
+    Load->removeFromParent();
+    ASSERT_EQ(Load->getParent(), nullptr);
+    ASSERT_TRUE(BB->isInstrOrderValid());
+    Load->insertAfter(Ret);
+    ASSERT_TRUE(Ret->comesBefore(Load));
+    Load->removeFromParent();
+    Load->insertBefore(Ret);
+    ASSERT_TRUE(Load->comesBefore(Ret));
+    ASSERT_EQ(BB->size(), 4u);
+}
+
+TEST(InstructionTest, SpliceTest) {
+    // Split a block after its alloca, then merge it back.
+    Type *IntegerType = Type::getIntegerTy();
+    auto M = std::make_unique<Module>();
+    Function *F = Function::Create(FunctionType::get(IntegerType, {}), false, "f", M.get());
+    BasicBlock *Entry = BasicBlock::Create(F);
+    BasicBlock *Tail = BasicBlock::Create(F);
+    AllocaInst *Addr = AllocaInst::Create(IntegerType, 1, Entry);
+    StoreInst *Store = StoreInst::Create(ConstantInt::Create(1), Addr, Entry);
+    LoadInst *Load = LoadInst::Create(Addr, Entry);
+    RetInst *Ret = RetInst::Create(Load, Entry);
+    Tail->splice(Tail->end(), Entry, BasicBlock::iterator(Store), Entry->end());
+    JumpInst::Create(Tail, Entry);
+    ASSERT_EQ(Entry->size(), 2u);
+    ASSERT_EQ(Tail->size(), 3u);
+    ASSERT_EQ(&Tail->front(), Store);
+    ASSERT_EQ(Tail->getTerminator(), Ret);
+    ASSERT_EQ(Load->getParent(), Tail);
+    ASSERT_TRUE(Store->comesBefore(Ret));
+
+    Entry->getTerminator()->eraseFromParent();
+    Entry->splice(Entry->end(), Tail);
+    ASSERT_EQ(Entry->size(), 4u);
+    ASSERT_TRUE(Tail->empty());
+    ASSERT_EQ(Ret->getParent(), Entry);
+    ASSERT_TRUE(Addr->comesBefore(Ret));
+}
+
+TEST(InstructionTest, ReplaceAllUsesTest) {
+    Type *IntegerType = Type::getIntegerTy();
+    auto M = std::make_unique<Module>();
+    Function *F = Function::Create(FunctionType::get(IntegerType, {}), false, "f", M.get());
+    BasicBlock *BB = BasicBlock::Create(F);
+    AllocaInst *From = AllocaInst::Create(IntegerType, 1, BB);
+    AllocaInst *To = AllocaInst::Create(IntegerType, 1, BB);
+    StoreInst *Store = StoreInst::Create(ConstantInt::Create(1), From, BB);
+    LoadInst *L1 = LoadInst::Create(From, BB);
+    LoadInst *L2 = LoadInst::Create(To, BB);
+    BinaryInst *Add = BinaryInst::CreateAdd(L1, L1, IntegerType, BB);
+    ASSERT_TRUE(From->hasNUses(2));
+    ASSERT_TRUE(To->hasOneUse());
+    ASSERT_TRUE(L1->hasNUses(2));
+    ASSERT_TRUE(L2->use_empty());
+
+    From->replaceAllUsesWith(To);
+    ASSERT_TRUE(From->use_empty());
+    ASSERT_TRUE(To->hasNUses(3));
+    ASSERT_TRUE(To->hasNUsesOrMore(2));
+    ASSERT_EQ(Store->getOperand(1), To);
+    ASSERT_EQ(L1->getPointerOperand(), To);
+    unsigned Walked = 0;
+    for (auto &U : To->getUserView()) {
+        ASSERT_EQ(U.get(), To);
+        ++Walked;
+    }
+    ASSERT_EQ(Walked, 3u);
+
+    // Dropping the uses, and uses going away with their user.
+    L1->replaceAllUsesWith(nullptr);
+    ASSERT_TRUE(L1->use_empty());
+    ASSERT_EQ(Add->getOperand(0), nullptr);
+    Add->getOperandList()[1].set(L2);
+    ASSERT_TRUE(L2->hasOneUse());
+    Add->eraseFromParent();
+    ASSERT_TRUE(L2->use_empty());
+    L1->eraseFromParent();
+    ASSERT_TRUE(To->hasNUses(2));
+    RetInst::Create(L2, BB);
+}
+
+TEST(InstructionTest, NamePoolTest) {
+    // Names are interned once per module, the symbol tables follow renames.
+    Type *IntegerType = Type::getIntegerTy();
+    auto M = std::make_unique<Module>();
+    Function *F = Function::Create(FunctionType::get(IntegerType, {IntegerType}), false, "f", M.get());
+    BasicBlock *BB = BasicBlock::Create(F);
+    BB->setName("entry");
+    AllocaInst *A1 = AllocaInst::Create(IntegerType, 1, BB);
+    AllocaInst *A2 = AllocaInst::Create(IntegerType, 4, BB);
+    A1->setName("entry");
+    A2->setName("entry");
+    ASSERT_EQ(A1->getName(), "entry");
+    ASSERT_EQ(A1->getName().data(), A2->getName().data());
+    ASSERT_EQ(BB->getName().data(), A1->getName().data());
+    F->getArg(0)->setName("x");
+    ASSERT_EQ(F->getArg(0)->getName(), "x");
+    A2->setName("");
+    ASSERT_FALSE(A2->hasName());
+
+    GlobalVariable *G = GlobalVariable::Create(IntegerType, 1, false, "g", M.get());
+    std::string NewName = "h";
+    G->setName(NewName);
+    NewName = "x";
+    ASSERT_EQ(M->getGlobalVariable("g"), nullptr);
+    ASSERT_EQ(M->getGlobalVariable("h"), G);
+    ASSERT_EQ(M->getFunction("f"), F);
+
+    // Variadic operands from braced lists.
+    OffsetInst *Offset = OffsetInst::Create(IntegerType, A2, {ConstantInt::Create(1)}, {4}, BB);
+    ASSERT_EQ(Offset->getNumOperands(), 2u);
+    ASSERT_EQ(Offset->getPointerOperand(), A2);
+    ASSERT_EQ(Offset->getBound(0), 4u);
+    LoadInst *Load = LoadInst::Create(Offset, BB);
+    CallInst *Call = CallInst::Create(F, {Load}, BB);
+    ASSERT_EQ(Call->getArgOperand(0), Load);
+    RetInst::Create(Call, BB);
+}
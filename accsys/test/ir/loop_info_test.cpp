@@ -0,0 +1,175 @@
+#include "ir/ir.h"
+#include "ir/dominators.h"
+#include "ir/loop_info.h"
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+using Blocks = std::vector<BasicBlock *>;
+
+// Two nested while loops as the front end lowers them, the outer one with
+// a short circuit condition and the inner one with a break:
+//   entry -> cond1; cond1 -> cond2 | exit; cond2 -> body | exit;
+//   body -> inner; inner -> inner.body | after; inner.body -> latch | after;
+//   latch -> inner; after -> cond1.
+// Plus an unreachable block looping on itself.
+struct NestedLoops {
+    Module M;
+    Function *F;
+    BasicBlock *Entry, *Cond1, *Cond2, *Body, *Inner, *InnerBody, *Latch, *After, *Exit, *Dead;
+
+    NestedLoops() {
+        Type *IntegerType = Type::getIntegerTy();
+        F = Function::Create(FunctionType::get(IntegerType, {IntegerType}), false, "f", &M);
+        Entry = BasicBlock::Create(F);
+        Cond1 = BasicBlock::Create(F);
+        Cond2 = BasicBlock::Create(F);
+        Body = BasicBlock::Create(F);
+        Inner = BasicBlock::Create(F);
+        InnerBody = BasicBlock::Create(F);
+        Latch = BasicBlock::Create(F);
+        After = BasicBlock::Create(F);
+        Exit = BasicBlock::Create(F);
+        Dead = BasicBlock::Create(F);
+        Value *N = F->getArg(0);
+        JumpInst::Create(Cond1, Entry);
+        BranchInst::Create(Cond2, Exit, N, Cond1);
+        BranchInst::Create(Body, Exit, N, Cond2);
+        JumpInst::Create(Inner, Body);
+        BranchInst::Create(InnerBody, After, N, Inner);
+        BranchInst::Create(Latch, After, N, InnerBody);
+        JumpInst::Create(Inner, Latch);
+        JumpInst::Create(Cond1, After);
+        RetInst::Create(N, Exit);
+        JumpInst::Create(Dead, Dead);
+    }
+};
+
+} // namespace
+
+TEST(LoopInfoTest, NestedLoopTest) {
+    NestedLoops L;
+    DominatorTree DT(*L.F);
+    LoopInfo LI(DT);
+    ASSERT_EQ(LI.getTopLevelLoops().size(), 1u);
+    Loop *Outer = LI.getLoopFor(L.Cond1);
+    Loop *Inner = LI.getLoopFor(L.Inner);
+    ASSERT_NE(Outer, nullptr);
+    ASSERT_EQ(*LI.begin(), Outer);
+    ASSERT_EQ(Outer->getSubLoops(), std::vector<Loop *> {Inner});
+    ASSERT_EQ(Inner->getParentLoop(), Outer);
+    ASSERT_EQ(LI.getLoopsInPreorder(), (std::vector<Loop *> {Outer, Inner}));
+
+    ASSERT_EQ(Outer->getHeader(), L.Cond1);
+    ASSERT_EQ(Outer->blocks(), (Blocks {L.Cond1, L.Cond2, L.Body, L.Inner, L.InnerBody, L.After, L.Latch}));
+    ASSERT_EQ(Inner->blocks(), (Blocks {L.Inner, L.InnerBody, L.Latch}));
+    ASSERT_TRUE(Outer->contains(Inner));
+    ASSERT_FALSE(Inner->contains(Outer));
+    ASSERT_TRUE(Outer->contains(L.Latch));
+    ASSERT_FALSE(Inner->contains(L.After));
+
+    ASSERT_EQ(LI.getLoopFor(L.After), Outer);
+    ASSERT_EQ(LI.getLoopFor(L.Latch), Inner);
+    ASSERT_EQ(LI.getLoopFor(L.Entry), nullptr);
+    ASSERT_EQ(LI.getLoopFor(L.Dead), nullptr);
+    ASSERT_EQ(LI.getLoopDepth(L.InnerBody), 2u);
+    ASSERT_EQ(LI.getLoopDepth(L.Cond2), 1u);
+    ASSERT_EQ(LI.getLoopDepth(L.Exit), 0u);
+    ASSERT_TRUE(LI.isLoopHeader(L.Inner));
+    ASSERT_FALSE(LI.isLoopHeader(L.Cond2));
+    ASSERT_TRUE(Inner->isInnermost());
+    ASSERT_TRUE(Outer->isOutermost());
+
+    ASSERT_EQ(Outer->getLoopLatch(), L.After);
+    ASSERT_EQ(Outer->getExitingBlocks(), (Blocks {L.Cond1, L.Cond2}));
+    ASSERT_EQ(Outer->getExitingBlock(), nullptr);
+    ASSERT_EQ(Outer->getExitBlock(), L.Exit);
+    ASSERT_EQ(Outer->getLoopPreheader(), L.Entry);
+    ASSERT_EQ(Inner->getLoopLatch(), L.Latch);
+    ASSERT_EQ(Inner->getExitingBlocks(), (Blocks {L.Inner, L.InnerBody}));
+    ASSERT_EQ(Inner->getExitBlocks(), Blocks {L.After});
+    ASSERT_EQ(Inner->getLoopPreheader(), L.Body);
+
+    // A second latch, and an entry that is not a preheader.
+    L.Body->getTerminator()->eraseFromParent();
+    BranchInst::Create(L.Inner, L.Exit, L.F->getArg(0), L.Body);
+    L.Latch->getTerminator()->eraseFromParent();
+    BranchInst::Create(L.Inner, L.Inner, L.F->getArg(0), L.Latch);
+    L.After->getTerminator()->eraseFromParent();
+    JumpInst::Create(L.Inner, L.After);
+    DT.recalculate(*L.F);
+    LI.analyze(DT);
+    Inner = LI.getLoopFor(L.Inner);
+    ASSERT_EQ(LI.getTopLevelLoops(), std::vector<Loop *> {Inner});
+    ASSERT_EQ(LI.getLoopFor(L.Cond1), nullptr);
+    Blocks Latches = Inner->getLoopLatches();
+    ASSERT_TRUE(std::is_permutation(Latches.begin(), Latches.end(), Blocks {L.Latch, L.After}.begin()));
+    ASSERT_EQ(Inner->getLoopLatch(), nullptr);
+    ASSERT_EQ(Inner->getLoopPredecessor(), L.Body);
+    ASSERT_EQ(Inner->getLoopPreheader(), nullptr);
+}
+
+TEST(LoopInfoTest, RandomCFGTest) {
+    // Every loop must be the natural loop of the back edges to its header,
+    // with the loops nested in it inside of it.
+    Type *IntegerType = Type::getIntegerTy();
+    constexpr unsigned NumBlocks = 16;
+    std::mt19937 Rand(7);
+    for (unsigned Round = 0; Round != 50; ++Round) {
+        Module M;
+        Function *F = Function::Create(FunctionType::get(IntegerType, {IntegerType}), false, "f", &M);
+        Value *C = F->getArg(0);
+        Blocks BBs;
+        for (unsigned i = 0; i != NumBlocks; ++i)
+            BBs.push_back(BasicBlock::Create(F));
+        for (BasicBlock *BB : BBs) {
+            if (Rand() % 5 == 0)
+                RetInst::Create(C, BB);
+            else
+                BranchInst::Create(BBs[Rand() % NumBlocks], BBs[Rand() % NumBlocks], C, BB);
+        }
+        DominatorTree DT(*F);
+        LoopInfo LI(DT);
+
+        for (BasicBlock *Header : BBs) {
+            Blocks Body;
+            for (BasicBlock *Pred : Header->predecessors())
+                if (DT.isReachableFromEntry(Pred) && DT.dominates(Header, Pred))
+                    Body.push_back(Pred);
+            Loop *L = LI.getLoopFor(Header);
+            if (Body.empty()) {
+                ASSERT_FALSE(LI.isLoopHeader(Header)) << "round " << Round;
+                continue;
+            }
+            ASSERT_TRUE(LI.isLoopHeader(Header)) << "round " << Round;
+            Blocks Worklist = Body;
+            Body.assign(1, Header);
+            while (!Worklist.empty()) {
+                BasicBlock *BB = Worklist.back();
+                Worklist.pop_back();
+                if (std::find(Body.begin(), Body.end(), BB) != Body.end())
+                    continue;
+                Body.push_back(BB);
+                for (BasicBlock *Pred : BB->predecessors())
+                    if (DT.isReachableFromEntry(Pred))
+                        Worklist.push_back(Pred);
+            }
+            ASSERT_EQ(L->getNumBlocks(), Body.size()) << "round " << Round;
+            for (BasicBlock *BB : Body)
+                ASSERT_TRUE(L->contains(BB)) << "round " << Round;
+            for (BasicBlock *BB : L->blocks())
+                ASSERT_TRUE(LI.getLoopFor(BB) == L || L->contains(LI.getLoopFor(BB)));
+            if (Loop *Outer = L->getParentLoop()) {
+                ASSERT_TRUE(Outer->contains(Header));
+                ASSERT_GT(Outer->getNumBlocks(), L->getNumBlocks());
+            }
+            for (Loop *Sub : L->getSubLoops())
+                ASSERT_EQ(Sub->getParentLoop(), L);
+        }
+    }
+}
@@ -43,4 +43,19 @@ TEST(TypeTest, FunctionTypeTest) {
     ASSERT_EQ(FuncType->getParamType(1), UnitTy);
     ASSERT_EQ(FuncType->getReturnType(), UnitTy);
     ASSERT_TRUE(isa<FunctionType>(FuncType));
-}
\ No newline at end of file
+}
+TEST(TypeTest, FunctionTypeUniqueTest) {
+    // Function types are uniqued by structure
+    Type *IntegerType = Type::getIntegerTy();
+    Type *UnitTy = Type::getUnitTy();
+    std::vector<Type *> Params = {IntegerType, PointerType::get(IntegerType)};
+    FunctionType *FuncType = FunctionType::get(UnitTy, Params);
+    ASSERT_EQ(FunctionType::get(UnitTy, {IntegerType, PointerType::get(IntegerType)}), FuncType);
+    // the interned type does not depend on the caller's parameters
+    Params[0] = UnitTy;
+    ASSERT_EQ(FuncType->getParamType(0), IntegerType);
+    ASSERT_NE(FunctionType::get(UnitTy, Params), FuncType);
+    ASSERT_NE(FunctionType::get(IntegerType, {IntegerType, PointerType::get(IntegerType)}), FuncType);
+    ASSERT_NE(FunctionType::get(UnitTy, {IntegerType}), FuncType);
+    ASSERT_EQ(FunctionType::get(UnitTy), FunctionType::get(UnitTy, {}));
+}
@@ -0,0 +1,110 @@
+#include "utils/bit_vector.h"
+#include "utils/indexed_map.h"
+#include "utils/sparse_bit_vector.h"
+
+#include "gtest/gtest.h"
+#include <vector>
+
+TEST(UtilsTest, BitVectorTest) {
+    BitVector BV(130);
+    ASSERT_EQ(BV.size(), 130u);
+    ASSERT_TRUE(BV.none());
+    BV.set(0).set(64).set(129);
+    ASSERT_TRUE(BV.test(64));
+    ASSERT_FALSE(BV[63]);
+    ASSERT_EQ(BV.count(), 3u);
+    ASSERT_EQ(BV.find_first(), 0);
+    ASSERT_EQ(BV.find_next(0), 64);
+    ASSERT_EQ(BV.find_next(64), 129);
+    ASSERT_EQ(BV.find_next(129), -1);
+    std::vector<unsigned> Bits(BV.set_bits().begin(), BV.set_bits().end());
+    ASSERT_EQ(Bits, (std::vector<unsigned> {0, 64, 129}));
+    ASSERT_FALSE(BV.test_and_set(1));
+    ASSERT_TRUE(BV.test_and_set(1));
+    BV.reset(1);
+
+    // growing keeps the bits, new ones take the given value.
+    BV.resize(200, true);
+    ASSERT_EQ(BV.count(), 3u + 70u);
+    BV.resize(130);
+    ASSERT_EQ(BV.count(), 3u);
+    BitVector All(70, true);
+    ASSERT_EQ(All.count(), 70u);
+    All.set();
+    ASSERT_EQ(All.count(), 70u);
+
+    // set operations, the shorter operand reads as zero past its end.
+    BitVector Other(70);
+    Other.set(0).set(5);
+    BitVector Union = BV;
+    Union |= Other;
+    ASSERT_EQ(Union.count(), 4u);
+    ASSERT_TRUE(Union.anyCommon(Other));
+    BitVector Common = BV;
+    Common &= Other;
+    ASSERT_EQ(Common.count(), 1u);
+    ASSERT_TRUE(Common.test(0));
+    Union.reset(Other);
+    ASSERT_EQ(Union.count(), 2u);
+    ASSERT_FALSE(Union.anyCommon(Other));
+    BitVector Short(1);
+    Short.set(0);
+    ASSERT_EQ(Common, Short);
+    ASSERT_NE(Common, Other);
+}
+
+TEST(UtilsTest, SparseBitVectorTest) {
+    SparseBitVector A, B;
+    ASSERT_TRUE(A.empty());
+    ASSERT_EQ(A.find_first(), -1);
+    A.set(3);
+    A.set(1000);
+    A.set(127);
+    A.set(128);
+    ASSERT_TRUE(A.test(1000));
+    ASSERT_FALSE(A.test(999));
+    ASSERT_EQ(A.count(), 4u);
+    ASSERT_EQ(A.find_first(), 3);
+    std::vector<unsigned> Bits(A.begin(), A.end());
+    ASSERT_EQ(Bits, (std::vector<unsigned> {3, 127, 128, 1000}));
+
+    B.set(128);
+    B.set(5000);
+    ASSERT_TRUE(A.intersects(B));
+    ASSERT_TRUE(A |= B);
+    ASSERT_FALSE(A |= B);
+    ASSERT_EQ(A.count(), 5u);
+    ASSERT_TRUE(A.intersectWithComplement(B));
+    ASSERT_FALSE(A.intersects(B));
+    ASSERT_EQ(A.count(), 3u);
+    ASSERT_FALSE(A.intersectWithComplement(B));
+
+    SparseBitVector C = A;
+    C.set(5000);
+    ASSERT_TRUE(C &= B);
+    ASSERT_EQ(std::vector<unsigned>(C.begin(), C.end()), std::vector<unsigned> {5000});
+    ASSERT_FALSE(C &= B);
+    C.reset(5000);
+    ASSERT_TRUE(C.empty());
+    ASSERT_EQ(C.begin(), C.end());
+    ASSERT_FALSE(A.test_and_set(64));
+    ASSERT_TRUE(A.test_and_set(64));
+    ASSERT_NE(A, B);
+    B = A;
+    ASSERT_EQ(A, B);
+}
+
+TEST(UtilsTest, IndexedMapTest) {
+    IndexedMap<int> Map(-1);
+    Map.grow(9);
+    ASSERT_EQ(Map.size(), 10u);
+    ASSERT_EQ(Map[9u], -1);
+    Map[3u] = 7;
+    ASSERT_EQ(Map[3u], 7);
+    ASSERT_TRUE(Map.inBounds(9u));
+    ASSERT_FALSE(Map.inBounds(10u));
+    Map.grow(4);
+    ASSERT_EQ(Map.size(), 10u);
+    Map.reset();
+    ASSERT_EQ(Map[3u], -1);
+}
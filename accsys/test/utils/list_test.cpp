@@ -2,6 +2,8 @@
 
 
 #include "gtest/gtest.h"
+#include <iterator>
+#include <vector>
 
 TEST(UtilsTest, ListEmptyTest) {
     List<PayLoad> Ls;
@@ -11,4 +13,52 @@ TEST(UtilsTest, ListEmptyTest) {
     ASSERT_FALSE(Ls.empty());
     Ls.erase(Ls.begin());
     ASSERT_TRUE(Ls.empty());
-}
\ No newline at end of file
+}
+TEST(UtilsTest, ListSizeTest) {
+    List<PayLoad> Ls;
+    ASSERT_EQ(Ls.size(), 0u);
+    for (int i = 0; i < 4; ++i)
+        Ls.push_back(new PayLoad(i));
+    Ls.insertAfter(Ls.begin(), new PayLoad(4));
+    ASSERT_EQ(Ls.size(), 5u);
+    delete Ls.remove(Ls.begin());
+    Ls.pop_back();
+    ASSERT_EQ(Ls.size(), 3u);
+    Ls.clear();
+    ASSERT_EQ(Ls.size(), 0u);
+    ASSERT_TRUE(Ls.empty());
+}
+
+TEST(UtilsTest, ListSpliceTest) {
+    List<PayLoad> A, B;
+    for (int i = 0; i < 4; ++i)
+        A.push_back(new PayLoad(i));
+    for (int i = 4; i < 8; ++i)
+        B.push_back(new PayLoad(i));
+    auto Values = [](List<PayLoad> &Ls) {
+        std::vector<int> V;
+        for (auto &P : Ls)
+            V.push_back(P.Value);
+        return V;
+    };
+    // part of another list: B[1, 3) before A[2].
+    auto First = ++B.begin(), Last = First;
+    std::advance(Last, 2);
+    A.splice(std::next(A.begin(), 2), B, First, Last);
+    ASSERT_EQ(Values(A), (std::vector<int> {0, 1, 5, 6, 2, 3}));
+    ASSERT_EQ(Values(B), (std::vector<int> {4, 7}));
+    ASSERT_EQ(A.size(), 6u);
+    ASSERT_EQ(B.size(), 2u);
+    // within a list: the front to the back.
+    A.splice(A.end(), A, A.begin());
+    ASSERT_EQ(Values(A), (std::vector<int> {1, 5, 6, 2, 3, 0}));
+    ASSERT_EQ(A.size(), 6u);
+    // all of another list.
+    A.splice(A.begin(), B);
+    ASSERT_EQ(Values(A), (std::vector<int> {4, 7, 1, 5, 6, 2, 3, 0}));
+    ASSERT_EQ(A.size(), 8u);
+    ASSERT_TRUE(B.empty());
+    B.splice(B.end(), A);
+    ASSERT_EQ(B.size(), 8u);
+    ASSERT_TRUE(A.empty());
+}
@@ -0,0 +1,41 @@
+#include "utils/slab_allocator.h"
+
+#include "gtest/gtest.h"
+
+TEST(UtilsTest, SlabAllocatorReuseTest) {
+    SlabAllocator A;
+    void *P1 = A.allocate(40);
+    void *P2 = A.allocate(40);
+    ASSERT_NE(P1, P2);
+    ASSERT_EQ(A.getNumSlabs(), 1);
+    // freed blocks are reused by allocations of the same size class
+    A.deallocate(P1, 40);
+    ASSERT_EQ(A.allocate(37), P1);
+    // but not by other size classes
+    A.deallocate(P2, 40);
+    ASSERT_NE(A.allocate(64), P2);
+    ASSERT_EQ(A.allocate(40), P2);
+}
+
+TEST(UtilsTest, SlabAllocatorGrowTest) {
+    SlabAllocator A;
+    for (int i = 0; i < 10000; ++i)
+        A.allocate(SlabAllocator::MaxBlockSize);
+    ASSERT_GE(A.getTotalMemory(), 10000 * SlabAllocator::MaxBlockSize);
+    // slabs grow, so the count stays far below one per 16 KB
+    ASSERT_LT(A.getNumSlabs(), 10000 * SlabAllocator::MaxBlockSize / (16 * 1024));
+}
+
+TEST(UtilsTest, SlabAllocatorOwnerTest) {
+    SlabAllocator A;
+    void *Small = SlabAllocator::allocateOwned(&A, 64);
+    void *Large = SlabAllocator::allocateOwned(&A, 4 * SlabAllocator::MaxBlockSize);
+    void *Heap = SlabAllocator::allocateOwned(nullptr, 64);
+    ASSERT_EQ(SlabAllocator::getOwner(Small), &A);
+    ASSERT_EQ(SlabAllocator::getOwner(Large), nullptr);
+    ASSERT_EQ(SlabAllocator::getOwner(Heap), nullptr);
+    SlabAllocator::deallocateOwned(Small, 64);
+    SlabAllocator::deallocateOwned(Large, 4 * SlabAllocator::MaxBlockSize);
+    SlabAllocator::deallocateOwned(Heap, 64);
+    ASSERT_EQ(SlabAllocator::allocateOwned(&A, 64), Small);
+}
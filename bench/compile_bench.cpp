@@ -0,0 +1,221 @@
+#include "sysy_gen.h"
+
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fmt/core.h>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+// usage: compile_bench [--compiler=<path>] [--axis=<field>] [--steps=N]
+//                      [--repeat=N] [--max-exponent=X]
+// Sweeps one field of WorkloadShape at a time, doubling it each step,
+// and times every phase of the compiler through its --time-trace. The
+// growth exponent k of time ~ field^k is fitted per phase over the
+// sweep; exits with 1 if any phase grows faster than --max-exponent.
+
+namespace
+{
+
+struct Axis
+{
+    const char *name;
+    int WorkloadShape::*field;
+    int base;
+};
+
+const Axis axes[] = {
+    {"functions", &WorkloadShape::functions, 32},   {"nesting", &WorkloadShape::nesting, 16},
+    {"statements", &WorkloadShape::statements, 128}, {"expr-terms", &WorkloadShape::expr_terms, 128},
+    {"globals", &WorkloadShape::globals, 128},       {"chain", &WorkloadShape::chain, 32},
+};
+
+// phases of the time trace reported by the benchmark
+const char *const phases[] = {"parse", "semantic analysis", "IR generation", "IR print", "compile"};
+constexpr int num_phases = sizeof(phases) / sizeof(phases[0]);
+
+// shorter than this, a phase is timer noise and kept out of the fit
+constexpr double min_fit_ms = 0.1;
+
+// total duration in ms of each event name of a trace written by the
+// compiler, one event per line
+std::map<std::string, double> read_trace(const std::string &path)
+{
+    std::map<std::string, double> dur;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line))
+    {
+        auto name = line.find("\"name\":\"");
+        auto d = line.find("\"dur\":");
+        if (name == std::string::npos || d == std::string::npos)
+            continue;
+        name += 8;
+        std::string key = line.substr(name, line.find('"', name) - name);
+        dur[key] += std::atof(line.c_str() + d + 6) / 1e3;
+    }
+    return dur;
+}
+
+// least squares slope of log(time) over log(size), NaN with < 3 points
+double fit_exponent(const std::vector<double> &size, const std::vector<double> &ms)
+{
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    int n = 0;
+    for (std::size_t i = 0; i < size.size(); ++i)
+    {
+        if (ms[i] < min_fit_ms)
+            continue;
+        double x = std::log(size[i]), y = std::log(ms[i]);
+        sx += x;
+        sy += y;
+        sxx += x * x;
+        sxy += x * y;
+        ++n;
+    }
+    double den = n * sxx - sx * sx;
+    if (n < 3 || den == 0)
+        return std::numeric_limits<double>::quiet_NaN();
+    return (n * sxy - sx * sy) / den;
+}
+
+std::string shell_quote(const std::string &s)
+{
+    std::string q = "'";
+    for (char c : s)
+        q += c == '\'' ? std::string("'\\''") : std::string(1, c);
+    return q + "'";
+}
+
+// removes the scratch directory on every way out of main
+struct TempDir
+{
+    std::filesystem::path path;
+
+    explicit TempDir(std::filesystem::path p) : path(std::move(p)) { std::filesystem::create_directories(path); }
+    ~TempDir()
+    {
+        std::error_code ec;
+        std::filesystem::remove_all(path, ec);
+    }
+    TempDir(const TempDir &) = delete;
+    TempDir &operator=(const TempDir &) = delete;
+};
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+#ifdef COMPILER_PATH
+    std::string compiler = COMPILER_PATH;
+#else
+    std::string compiler = "./compiler";
+#endif
+    std::string only_axis;
+    int steps = 5;
+    int repeat = 3;
+    double max_exponent = 1.3;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg.rfind("--compiler=", 0) == 0)
+            compiler = arg.substr(11);
+        else if (arg.rfind("--axis=", 0) == 0)
+            only_axis = arg.substr(7);
+        else if (arg.rfind("--steps=", 0) == 0)
+            steps = std::max(3, std::atoi(arg.c_str() + 8));
+        else if (arg.rfind("--repeat=", 0) == 0)
+            repeat = std::max(1, std::atoi(arg.c_str() + 9));
+        else if (arg.rfind("--max-exponent=", 0) == 0)
+            max_exponent = std::atof(arg.c_str() + 15);
+        else
+        {
+            fmt::print(stderr, "unknown option: {}\n", arg);
+            return 1;
+        }
+    }
+
+    auto stamp = std::chrono::steady_clock::now().time_since_epoch().count();
+    TempDir scratch(std::filesystem::temp_directory_path() / fmt::format("compile_bench.{}", stamp));
+    const auto &dir = scratch.path;
+    std::string source = (dir / "input.sy").string();
+    std::string output = (dir / "output.acc").string();
+    std::string trace = (dir / "trace.json").string();
+
+    std::vector<std::string> super_linear;
+    for (const Axis &axis : axes)
+    {
+        if (!only_axis.empty() && only_axis != axis.name)
+            continue;
+        fmt::print("axis {} (from {}, doubling {} times)\n", axis.name, axis.base, steps - 1);
+        fmt::print("  {:>10}  {:>10}", axis.name, "bytes");
+        for (auto *phase : phases)
+            fmt::print("  {:>17}", phase);
+        fmt::print("\n");
+
+        std::vector<double> sizes;
+        std::vector<std::vector<double>> times(num_phases);
+        for (int step = 0; step < steps; ++step)
+        {
+            WorkloadShape shape;
+            shape.*axis.field = axis.base << step;
+            std::string text;
+            generate_sysy(shape, text);
+            std::ofstream(source) << text;
+
+            // the fastest run is the least disturbed one
+            std::vector<double> best(num_phases, std::numeric_limits<double>::infinity());
+            for (int r = 0; r < repeat; ++r)
+            {
+                std::string cmd = fmt::format("{} {} {} --time-trace={} > /dev/null 2>&1", shell_quote(compiler),
+                                              shell_quote(source), shell_quote(output), shell_quote(trace));
+                if (std::system(cmd.c_str()) != 0)
+                {
+                    fmt::print(stderr, "compiler failed on {} = {}: {}\n", axis.name, shape.*axis.field, cmd);
+                    return 2;
+                }
+                auto dur = read_trace(trace);
+                for (int p = 0; p < num_phases; ++p)
+                    best[p] = std::min(best[p], dur[phases[p]]);
+            }
+
+            // fitted against the field, the indentation of deep nesting
+            // would skew the byte count
+            sizes.push_back(shape.*axis.field);
+            fmt::print("  {:>10}  {:>10}", shape.*axis.field, text.size());
+            for (int p = 0; p < num_phases; ++p)
+            {
+                times[p].push_back(best[p]);
+                fmt::print("  {:>14.3f} ms", best[p]);
+            }
+            fmt::print("\n");
+        }
+
+        fmt::print("  {:>22}", "exponent");
+        for (int p = 0; p < num_phases; ++p)
+        {
+            double k = fit_exponent(sizes, times[p]);
+            if (std::isnan(k))
+                fmt::print("  {:>17}", "-");
+            else
+                fmt::print("  {:>17.2f}", k);
+            if (k > max_exponent)
+                super_linear.push_back(fmt::format("{} / {}: {:.2f}", axis.name, phases[p], k));
+        }
+        fmt::print("\n\n");
+    }
+
+    if (super_linear.empty())
+        return 0;
+    fmt::print("super-linear growth (exponent > {:.2f}):\n", max_exponent);
+    for (auto &s : super_linear)
+        fmt::print("  {}\n", s);
+    return 1;
+}
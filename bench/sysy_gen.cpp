@@ -0,0 +1,182 @@
+#include "sysy_gen.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fmt/format.h>
+#include <iterator>
+
+namespace
+{
+
+constexpr int array_size = 4;
+
+class Generator
+{
+public:
+    Generator(const WorkloadShape &shape, std::string &out) : shape(shape), out(std::back_inserter(out)) {}
+
+    void program()
+    {
+        for (int i = 0; i < shape.globals; ++i)
+            fmt::format_to(out, "int g{} = {};\n", i, i + 1);
+        if (shape.array_dims > 0)
+            fmt::format_to(out, "int arr{};\n", dims(shape.array_dims));
+        for (int i = 0; i < shape.functions; ++i)
+            function(i);
+
+        fmt::format_to(out, "int main() {{\n    int s = getint();\n");
+        for (int i = 0; i < shape.functions; ++i)
+        {
+            if (shape.array_dims > 0)
+                fmt::format_to(out, "    s = s + f{}(s, arr);\n", i);
+            else
+                fmt::format_to(out, "    s = s + f{}(s);\n", i);
+        }
+        fmt::format_to(out, "    putint(s);\n    return 0;\n}}\n");
+    }
+
+private:
+    // "[4][4]..." with n dimensions
+    static std::string dims(int n)
+    {
+        std::string s;
+        for (int i = 0; i < n; ++i)
+            s += fmt::format("[{}]", array_size);
+        return s;
+    }
+
+    // a global if there are any, otherwise the parameter
+    std::string global(int i) const
+    {
+        return shape.globals > 0 ? fmt::format("g{}", i % shape.globals) : "x";
+    }
+
+    // a straight-line local if there are any, otherwise the parameter
+    std::string local(int i) const
+    {
+        return shape.statements > 0 ? fmt::format("v{}", i % shape.statements) : "x";
+    }
+
+    // an element of the array parameter, indices cycle through the array
+    std::string element(int i) const
+    {
+        if (shape.array_dims == 0)
+            return "x";
+        std::string s = "a";
+        for (int d = 0; d < shape.array_dims; ++d)
+            s += fmt::format("[{}]", (i + d) % array_size);
+        return s;
+    }
+
+    void function(int f)
+    {
+        if (shape.array_dims > 0)
+            fmt::format_to(out, "int f{}(int x, int a[]{}) {{\n", f, dims(shape.array_dims - 1));
+        else
+            fmt::format_to(out, "int f{}(int x) {{\n", f);
+
+        // long straight-line block
+        for (int i = 0; i < shape.statements; ++i)
+        {
+            std::string prev = i > 0 ? local(i - 1) : "x";
+            fmt::format_to(out, "    int v{} = {} * {} + {} - {};\n", i, prev, i % 7 + 2, global(i), element(i));
+        }
+
+        // one huge expression
+        fmt::format_to(out, "    int acc = x");
+        static const char *const ops[] = {" + ", " - ", " * ", " + ", " / "};
+        for (int i = 0; i < shape.expr_terms; ++i)
+        {
+            fmt::format_to(out, "{}", ops[i % 5]);
+            // keep the divisors away from zero
+            if (i % 5 == 4)
+                fmt::format_to(out, "{}", i + 1);
+            else if (i % 3 == 0)
+                fmt::format_to(out, "{}", local(i));
+            else if (i % 3 == 1)
+                fmt::format_to(out, "{}", global(i));
+            else
+                fmt::format_to(out, "({} + {})", element(i), i);
+        }
+        fmt::format_to(out, ";\n");
+
+        nested(1, "    ");
+        fmt::format_to(out, "    return acc;\n}}\n");
+    }
+
+    // a condition with a chain of alternating && and || operands
+    std::string condition(int level) const
+    {
+        std::string s = fmt::format("x > {}", level);
+        static const char *const rels[] = {" < ", " > ", " <= ", " >= ", " == ", " != "};
+        for (int i = 1; i < shape.chain; ++i)
+            s += fmt::format("{}{}{}{}", i % 2 ? " && " : " || ", global(level + i), rels[i % 6], local(level + i));
+        return s;
+    }
+
+    // if and while statements nested shape.nesting deep
+    void nested(int level, const std::string &indent)
+    {
+        if (level > shape.nesting)
+            return;
+        // indentation stops growing, so the size stays linear in the depth
+        std::string inner = level < 4 ? indent + "    " : indent;
+        if (level % 2)
+        {
+            fmt::format_to(out, "{}if ({}) {{\n", indent, condition(level));
+            fmt::format_to(out, "{}int n{} = acc + {};\n", inner, level, level);
+            nested(level + 1, inner);
+            fmt::format_to(out, "{}acc = acc + n{};\n", inner, level);
+            fmt::format_to(out, "{}}} else {{\n", indent);
+            fmt::format_to(out, "{}acc = acc - {};\n", inner, level);
+            fmt::format_to(out, "{}}}\n", indent);
+        }
+        else
+        {
+            fmt::format_to(out, "{}int n{} = 0;\n", indent, level);
+            fmt::format_to(out, "{}while (n{} < {} && ({})) {{\n", indent, level, level + 2, condition(level));
+            fmt::format_to(out, "{}n{} = n{} + 1;\n", inner, level, level);
+            nested(level + 1, inner);
+            fmt::format_to(out, "{}acc = acc * n{};\n", inner, level);
+            fmt::format_to(out, "{}}}\n", indent);
+        }
+    }
+
+    const WorkloadShape &shape;
+    std::back_insert_iterator<std::string> out;
+};
+
+} // namespace
+
+void generate_sysy(const WorkloadShape &shape, std::string &out)
+{
+    Generator(shape, out).program();
+}
+
+bool parse_shape_option(const char *option, WorkloadShape &shape)
+{
+    static const struct
+    {
+        const char *name;
+        int WorkloadShape::*field;
+    } fields[] = {
+        {"functions", &WorkloadShape::functions}, {"nesting", &WorkloadShape::nesting},
+        {"statements", &WorkloadShape::statements}, {"expr-terms", &WorkloadShape::expr_terms},
+        {"globals", &WorkloadShape::globals}, {"array-dims", &WorkloadShape::array_dims},
+        {"chain", &WorkloadShape::chain},
+    };
+    if (std::strncmp(option, "--", 2) != 0)
+        return false;
+    option += 2;
+    for (auto &f : fields)
+    {
+        std::size_t len = std::strlen(f.name);
+        if (std::strncmp(option, f.name, len) == 0 && option[len] == '=')
+        {
+            shape.*f.field = std::max(0, std::atoi(option + len + 1));
+            return true;
+        }
+    }
+    return false;
+}
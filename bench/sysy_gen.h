@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+
+// Shape of a synthetic SysY program. Each field scales one construct,
+// so a sweep over a single field shows how the compiler copes with it.
+struct WorkloadShape
+{
+    // functions besides main, each called once from main
+    int functions = 4;
+    // depth of the nested if/while statements in each function
+    int nesting = 4;
+    // straight-line statements at the top of each function
+    int statements = 16;
+    // terms of the long arithmetic expression in each function
+    int expr_terms = 16;
+    // global scalars, read all over the functions
+    int globals = 8;
+    // dimensions of the global array and the array parameters, 0: none
+    int array_dims = 2;
+    // operands of the &&/|| chain in each condition
+    int chain = 4;
+};
+
+// appends a program of the given shape to out. The program passes the
+// semantic checks and only uses statements the IR generator supports
+void generate_sysy(const WorkloadShape &shape, std::string &out);
+
+// parses "--<field>=<n>", returns false if the option is not a field
+bool parse_shape_option(const char *option, WorkloadShape &shape);
@@ -0,0 +1,39 @@
+#include "sysy_gen.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fmt/core.h>
+#include <string>
+
+// usage: sysy_gen [--functions=N] [--nesting=N] [--statements=N]
+//                 [--expr-terms=N] [--globals=N] [--array-dims=N]
+//                 [--chain=N] [-o <file>]
+// writes a synthetic SysY program to stdout or to the file
+int main(int argc, char **argv)
+{
+    WorkloadShape shape;
+    const char *output = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            output = argv[++i];
+        else if (!parse_shape_option(argv[i], shape))
+        {
+            fmt::print(stderr, "unknown option: {}\n", argv[i]);
+            return 1;
+        }
+    }
+
+    std::string text;
+    generate_sysy(shape, text);
+    std::FILE *out = output ? std::fopen(output, "w") : stdout;
+    if (out == nullptr)
+    {
+        fmt::print(stderr, "cannot write {}\n", output);
+        return 1;
+    }
+    std::fwrite(text.data(), 1, text.size(), out);
+    if (output)
+        std::fclose(out);
+    return 0;
+}
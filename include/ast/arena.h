@@ -0,0 +1,124 @@
+#pragma once
+#include "common/mem_stats.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bump allocator owning every node of one translation unit.
+// Nodes are never freed one by one: the whole tree goes away in reset(),
+// which only releases the slabs (plus the few registered cleanups).
+class AstArena
+{
+public:
+    AstArena() = default;
+    AstArena(const AstArena &) = delete;
+    AstArena &operator=(const AstArena &) = delete;
+    ~AstArena() { reset(); }
+
+    void *allocate(std::size_t size, std::size_t align);
+
+    template <typename T>
+    T *allocate_array(std::size_t n)
+    {
+        return static_cast<T *>(allocate(n * sizeof(T), alignof(T)));
+    }
+
+    // Construct a T in the arena. Objects that own memory outside the
+    // arena (e.g. std::vector members) get their destructor run on reset().
+    template <typename T, typename... Args>
+    T *make(Args &&...args)
+    {
+        T *obj = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        ++objects;
+        mem_counters[MC_AST].objects++;
+        if constexpr (!std::is_trivially_destructible_v<T>)
+            cleanups.push_back({[](void *p) { static_cast<T *>(p)->~T(); }, obj});
+        return obj;
+    }
+
+    // Copy a string into the arena, result is NUL terminated.
+    const char *copy_string(const char *str, std::size_t len);
+
+    // Release every object allocated so far.
+    void reset();
+
+    std::size_t bytes_allocated() const { return allocated; }
+    std::size_t objects_made() const { return objects; }
+
+private:
+    static constexpr std::size_t slab_size = 64 * 1024;
+
+    struct Cleanup
+    {
+        void (*fn)(void *);
+        void *obj;
+    };
+
+    std::vector<char *> slabs;
+    std::vector<Cleanup> cleanups;
+    char *cur = nullptr;
+    char *end = nullptr;
+    std::size_t allocated = 0;
+    std::size_t objects = 0;
+};
+
+// Growable array living in an AstArena, used for the child lists of the
+// AST. It is trivially destructible, so the nodes holding it need no
+// destructor; growing leaves the old buffer behind in the arena.
+template <typename T>
+class AstList
+{
+    static_assert(std::is_trivially_copyable_v<T>, "AstList only holds trivial elements");
+
+public:
+    using value_type = T;
+    using iterator = T *;
+    using const_iterator = const T *;
+
+    AstList() = default;
+    explicit AstList(AstArena *arena) : arena(arena) {}
+    AstList(AstArena *arena, std::initializer_list<T> init) : arena(arena)
+    {
+        for (const T &x : init)
+            push_back(x);
+    }
+
+    void push_back(const T &x)
+    {
+        if (count == capacity)
+            grow();
+        items[count++] = x;
+    }
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    T &operator[](std::size_t i) { return items[i]; }
+    const T &operator[](std::size_t i) const { return items[i]; }
+    T &back() { return items[count - 1]; }
+    iterator begin() { return items; }
+    iterator end() { return items + count; }
+    const_iterator begin() const { return items; }
+    const_iterator end() const { return items + count; }
+
+private:
+    void grow()
+    {
+        uint32_t new_capacity = capacity ? capacity * 2 : 4;
+        T *new_items = arena->allocate_array<T>(new_capacity);
+        if (count)
+            std::memcpy(new_items, items, count * sizeof(T));
+        items = new_items;
+        capacity = new_capacity;
+    }
+
+    T *items = nullptr;
+    uint32_t count = 0;
+    uint32_t capacity = 0;
+    AstArena *arena = nullptr;
+};
@@ -2,49 +2,13 @@
 #include <cstdint>
 #include <type_traits>
 #include <string>
+#include <string_view>
 #include <vector>
+#include "ast/arena.h"
+#include "ast/types.h"
 
 using namespace std;
 
-enum MyType
-{
-    INT,
-    VOID,
-    ALL,
-    FAIL // to show that Table.lookup didn't find var or func,
-         // or type doesn't match
-};
-
-struct varType
-{
-
-    // actually only need INT, but can be 'VOID' to
-    // represent that the function is void
-    MyType type;
-
-    // 0: scalar, >0: array
-    int dimension;
-
-    vector<int> dimension_size;
-
-    varType(MyType type, int d) : type(type), dimension(d) {}
-    varType(MyType type, int d, std::vector<int> d_size) : type(type), dimension(d_size.size()), dimension_size(d_size) {}
-    varType(const varType& other): type(other.type), dimension(other.dimension), dimension_size(other.dimension_size) {}
-    varType() {}
-};
-
-struct FuncType
-{
-    // input types
-    std::vector<varType> inputType;
-
-    // return type, here varType.type can be 'VOID'
-    MyType returnType;
-    FuncType(std::vector<varType> iT, MyType rT) : inputType(iT), returnType(rT) {}
-    FuncType(const FuncType& other): inputType(other.inputType), returnType(other.returnType) {}
-    FuncType(){}
-};
-
 enum OpType
 {
 #define OpcodeDefine(x, s) x,
@@ -53,10 +17,24 @@ enum OpType
 
 enum NodeType
 {
-#define TreeNodeDefine(x) x,
+#define TreeNodeDefine(x, cls, name) x,
 #include "common/common.def"
 };
 
+// A declaration resolved by semantic analysis. Nodes refer to it by
+// symbol id, the index into TreeRoot::symbols.
+struct Symbol
+{
+    std::string_view name;
+    varType var_type;   // variables and parameters
+    FuncType func_type; // functions
+    bool external = false; // runtime library function
+};
+constexpr uint32_t no_symbol = UINT32_MAX;
+
+// every node of the current translation unit lives in this arena
+extern AstArena *ast_arena;
+
 struct Node;
 using NodePtr = Node *;
 struct TreeExpr;
@@ -85,6 +63,8 @@ struct Node
 
 struct TreeExpr : public Node
 {
+    // set by type_check the first time the node is checked
+    varType checked_type;
     TreeExpr(NodeType type) : Node(type) {}
 };
 
@@ -116,8 +96,8 @@ struct TreeWhileStmt : public TreeExpr
 struct TreeWhileControlStmt : public TreeExpr
 {
     constexpr static NodeType this_type = ND_LoopControlExpr;
-    string controlType;
-    TreeWhileControlStmt(string controlType) : TreeExpr(this_type), controlType(controlType) {}
+    std::string_view controlType;
+    TreeWhileControlStmt(std::string_view controlType) : TreeExpr(this_type), controlType(controlType) {}
 };
 
 struct TreeReturnStmt : public TreeExpr
@@ -155,23 +135,25 @@ struct TreeFuncExpr : public TreeExpr
 {
     // TODO: complete your code here;
     constexpr static NodeType this_type = ND_FuncExpr;
-    std::string name;
-    std::vector<ExprPtr> varNames;
+    std::string_view name;
+    AstList<ExprPtr> varNames;
+    uint32_t symbol = no_symbol; // set by sa
 
     void append(ExprPtr x)
     {
         varNames.push_back(x);
     }
-    TreeFuncExpr(string name, vector<ExprPtr> varNames) : TreeExpr(this_type), name(name), varNames(varNames) {}
+    TreeFuncExpr(std::string_view name, AstList<ExprPtr> varNames) : TreeExpr(this_type), name(name), varNames(varNames) {}
 };
 
 struct TreeVarExpr : public TreeExpr
 {
     // TODO: complete your code here;
     constexpr static NodeType this_type = ND_ValExpr;
-    std::string name;
-    std::vector<ExprPtr> index; // eg. a[1][2] means pushing 1 and 2 to vector
-    TreeVarExpr(std::string name, std::vector<ExprPtr> index) : TreeExpr(this_type), name(name), index(index) {}
+    std::string_view name;
+    AstList<ExprPtr> index; // eg. a[1][2] means pushing 1 and 2 to vector
+    uint32_t symbol = no_symbol; // set by sa
+    TreeVarExpr(std::string_view name, AstList<ExprPtr> index) : TreeExpr(this_type), name(name), index(index) {}
 };
 
 struct TreeNumber : public TreeExpr
@@ -187,20 +169,22 @@ struct TreeRoot : public TreeExpr
 {
     // TODO: complete your code here;
     constexpr static NodeType this_type = ND_Root;
-    std::vector<ExprPtr> rootItems;
+    AstList<ExprPtr> rootItems;
+    // every declaration of the unit, filled by sa
+    std::vector<Symbol> symbols;
     void append(ExprPtr x)
     {
-        rootItems.insert(rootItems.begin(), x);
+        rootItems.push_back(x);
     }
-    TreeRoot(std::vector<ExprPtr> rootItems) : TreeExpr(this_type), rootItems(rootItems) {}
+    TreeRoot(AstList<ExprPtr> rootItems) : TreeExpr(this_type), rootItems(rootItems) {}
 };
 
 struct TreeVarDecl : public TreeExpr
 {
     MyType type;
-    std::vector<ExprPtr> assignStmtNodes;
+    AstList<ExprPtr> assignStmtNodes;
     constexpr static NodeType this_type = ND_VarDecl;
-    TreeVarDecl(MyType type, vector<ExprPtr> assignStmtNodes) : TreeExpr(this_type), type(type), assignStmtNodes(assignStmtNodes) {}
+    TreeVarDecl(MyType type, AstList<ExprPtr> assignStmtNodes) : TreeExpr(this_type), type(type), assignStmtNodes(assignStmtNodes) {}
     void append(ExprPtr x)
     {
         assignStmtNodes.push_back(x);
@@ -211,8 +195,8 @@ struct TreeBlock : public TreeExpr
 {
     // TODO: complete your code here;
     constexpr static NodeType this_type = ND_Block;
-    std::vector<ExprPtr> blockItems;
-    TreeBlock(std::vector<ExprPtr> blockItems) : TreeExpr(this_type), blockItems(blockItems) {}
+    AstList<ExprPtr> blockItems;
+    TreeBlock(AstList<ExprPtr> blockItems) : TreeExpr(this_type), blockItems(blockItems) {}
     void append(ExprPtr x)
     {
         blockItems.push_back(x);
@@ -223,16 +207,20 @@ struct TreeFuncDef : public TreeExpr
 {
     // TODO: complete your code here;
     constexpr static NodeType this_type = ND_FuncDef;
-    std::string funcName;
-    std::vector<std::pair<std::string, varType>> input_params;
+    std::string_view funcName;
+    // the vector owns heap memory, the arena runs its destructor
+    std::vector<std::pair<std::string_view, varType>> input_params;
     FuncType type;
     ExprPtr blockNode;
-    TreeFuncDef(std::string funcName, std::vector<std::pair<std::string, varType>> input_params, MyType t, ExprPtr blockNode) : TreeExpr(this_type), funcName(funcName), input_params(input_params), blockNode(blockNode), type(std::vector<varType>{}, t)
+    // set by sa, the parameters get consecutive ids from first_param
+    uint32_t symbol = no_symbol;
+    uint32_t first_param = no_symbol;
+    TreeFuncDef(std::string_view funcName, std::vector<std::pair<std::string_view, varType>> input_params, MyType t, ExprPtr blockNode) : TreeExpr(this_type), funcName(funcName), input_params(std::move(input_params)), blockNode(blockNode)
     {
-        for (int i = 0; i < input_params.size(); ++i)
-        {
-            type.inputType.push_back(input_params[i].second);
-        }
+        std::vector<varType> inputType;
+        for (auto &param : this->input_params)
+            inputType.push_back(param.second);
+        type = FuncType(inputType, t);
     }
 };
 
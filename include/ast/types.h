@@ -0,0 +1,127 @@
+#pragma once
+#include "common/mem_stats.h"
+#include <cstddef>
+#include <deque>
+#include <unordered_set>
+#include <vector>
+
+enum MyType
+{
+    INT,
+    VOID,
+    ALL,
+    FAIL // to show that Table.lookup didn't find var or func,
+         // or type doesn't match
+};
+
+struct VarTypeInfo;
+struct FuncTypeInfo;
+
+// Handle to an interned variable type. Every distinct (type, shape)
+// exists once in the TypeContext, so handles compare by pointer.
+// A default constructed handle is null, i.e. no type yet.
+class varType
+{
+public:
+    varType() = default;
+    // actually only need INT, but can be 'VOID' to
+    // represent that the function is void
+    // 0: scalar, >0: array whose sizes are unknown (0)
+    varType(MyType type, int d);
+    // the dimension follows d_size, d is kept for the old call sites
+    varType(MyType type, int d, std::vector<int> d_size);
+
+    const VarTypeInfo *operator->() const { return info; }
+    const VarTypeInfo &operator*() const { return *info; }
+    explicit operator bool() const { return info != nullptr; }
+    bool operator==(varType other) const { return info == other.info; }
+    bool operator!=(varType other) const { return info != other.info; }
+
+    // the type an array parameter sees: first dimension unknown.
+    // scalars decay to themselves
+    varType decayed() const;
+
+private:
+    explicit varType(const VarTypeInfo *info) : info(info) {}
+    friend class TypeContext;
+
+    const VarTypeInfo *info = nullptr;
+};
+
+struct VarTypeInfo
+{
+    MyType type;
+
+    // 0: scalar, >0: array
+    int dimension;
+
+    // one entry per dimension, 0 for the unknown first one of a parameter
+    std::vector<int> dimension_size;
+
+    varType decayed;
+};
+
+inline varType varType::decayed() const { return info->decayed; }
+
+// Handle to an interned function signature, compares by pointer.
+class FuncType
+{
+public:
+    FuncType() = default;
+    FuncType(const std::vector<varType> &iT, MyType rT);
+
+    const FuncTypeInfo *operator->() const { return info; }
+    const FuncTypeInfo &operator*() const { return *info; }
+    bool operator==(FuncType other) const { return info == other.info; }
+    bool operator!=(FuncType other) const { return info != other.info; }
+
+private:
+    explicit FuncType(const FuncTypeInfo *info) : info(info) {}
+    friend class TypeContext;
+
+    const FuncTypeInfo *info = nullptr;
+};
+
+struct FuncTypeInfo
+{
+    // input types
+    std::vector<varType> inputType;
+
+    // return type, here it can be 'VOID'
+    MyType returnType;
+};
+
+// Owns every type of the front end. Types are never freed.
+class TypeContext
+{
+public:
+    varType get_var_type(MyType type, std::vector<int> dimension_size);
+    FuncType get_func_type(MyType return_type, std::vector<varType> input_type);
+
+private:
+    struct VarHash
+    {
+        std::size_t operator()(const VarTypeInfo *t) const;
+    };
+    struct VarEq
+    {
+        bool operator()(const VarTypeInfo *a, const VarTypeInfo *b) const;
+    };
+    struct FuncHash
+    {
+        std::size_t operator()(const FuncTypeInfo *t) const;
+    };
+    struct FuncEq
+    {
+        bool operator()(const FuncTypeInfo *a, const FuncTypeInfo *b) const;
+    };
+
+    // deques keep the interned objects in place
+    std::deque<VarTypeInfo, CountingAllocator<VarTypeInfo, MC_Types>> var_types;
+    std::deque<FuncTypeInfo, CountingAllocator<FuncTypeInfo, MC_Types>> func_types;
+    std::unordered_set<const VarTypeInfo *, VarHash, VarEq, CountingAllocator<const VarTypeInfo *, MC_Types>> var_set;
+    std::unordered_set<const FuncTypeInfo *, FuncHash, FuncEq, CountingAllocator<const FuncTypeInfo *, MC_Types>>
+        func_set;
+};
+
+TypeContext &type_context();
@@ -0,0 +1,39 @@
+#pragma once
+#include "ast/ast.h"
+#include <cstdlib>
+
+// Static visitor over the AST. visit() switches once on node_type and
+// calls Derived::visit_<name>() for the node class listed in common.def,
+// so a pass pays a single jump per node instead of a chain of as<T>().
+//
+// A pass derives from AstVisitor<Pass, Ret, Args...> and defines the
+// handlers it cares about; the rest fall back to visit_default(). Extra
+// Args are forwarded unchanged to every handler.
+template <typename Derived, typename RetTy = void, typename... Args>
+class AstVisitor
+{
+public:
+    RetTy visit(ExprPtr node, Args... args)
+    {
+        switch (node->node_type)
+        {
+#define TreeNodeDefine(x, cls, name) \
+        case x:                      \
+            return derived()->visit_##name(static_cast<cls *>(node), args...);
+#include "common/common.def"
+        }
+        std::abort();
+    }
+
+    RetTy visit_default(ExprPtr, Args...) { return RetTy(); }
+
+#define TreeNodeDefine(x, cls, name)                 \
+    RetTy visit_##name(cls *node, Args... args)      \
+    {                                                \
+        return derived()->visit_default(node, args...); \
+    }
+#include "common/common.def"
+
+private:
+    Derived *derived() { return static_cast<Derived *>(this); }
+};
@@ -0,0 +1,62 @@
+#pragma once
+#include <fmt/core.h>
+
+// Leveled trace output of the compiler, one level per category.
+// A message is printed when its level is at most the level of its
+// category, so LL_Error is always the first to show up.
+enum LogLevel
+{
+    LL_Error,
+    LL_Warn,
+    LL_Info,
+    LL_Debug,
+    LL_Trace
+};
+
+enum LogCategory
+{
+#define LogCategoryDefine(x, s) x,
+#include "common/common.def"
+    LC_Count
+};
+
+// Levels above SYSY_LOG_MAX_LEVEL compile to nothing: their arguments
+// are not even evaluated. Release builds keep up to LL_Info, pass
+// -DSYSY_LOG_MAX_LEVEL=<level> to override.
+#ifndef SYSY_LOG_MAX_LEVEL
+#ifdef NDEBUG
+#define SYSY_LOG_MAX_LEVEL LL_Info
+#else
+#define SYSY_LOG_MAX_LEVEL LL_Trace
+#endif
+#endif
+
+// runtime level of each category, LL_Warn unless set by the driver
+extern LogLevel log_levels[LC_Count];
+
+inline bool log_enabled(LogCategory cat, LogLevel level)
+{
+    return level <= SYSY_LOG_MAX_LEVEL && level <= log_levels[cat];
+}
+
+void log_set_all(LogLevel level);
+
+// parses "<category>[:<level>]", category may be "all" and level
+// defaults to trace. returns false if either name is unknown
+bool log_configure(const char *spec);
+
+#define SYSY_LOG(cat, level, ...)                          \
+    do                                                     \
+    {                                                      \
+        if constexpr ((level) <= SYSY_LOG_MAX_LEVEL)       \
+        {                                                  \
+            if ((level) <= log_levels[cat])                \
+                fmt::print(__VA_ARGS__);                   \
+        }                                                  \
+    } while (0)
+
+#define LOG_ERROR(cat, ...) SYSY_LOG(cat, LL_Error, __VA_ARGS__)
+#define LOG_WARN(cat, ...) SYSY_LOG(cat, LL_Warn, __VA_ARGS__)
+#define LOG_INFO(cat, ...) SYSY_LOG(cat, LL_Info, __VA_ARGS__)
+#define LOG_DEBUG(cat, ...) SYSY_LOG(cat, LL_Debug, __VA_ARGS__)
+#define LOG_TRACE(cat, ...) SYSY_LOG(cat, LL_Trace, __VA_ARGS__)
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Live memory of the front end by category. The AST arena and the
+// containers below update the counters on every allocation; the IR
+// keeps its own counters, see accsys utils/alloc_stats.h.
+enum MemCategory
+{
+#define MemCategoryDefine(x, s) x,
+#include "common/common.def"
+    MC_Count
+};
+
+struct MemCounter
+{
+    std::size_t bytes = 0;
+    std::size_t objects = 0;
+
+    void add(std::size_t b, std::size_t n)
+    {
+        bytes += b;
+        objects += n;
+    }
+    void sub(std::size_t b, std::size_t n)
+    {
+        bytes -= b;
+        objects -= n;
+    }
+};
+
+extern MemCounter mem_counters[MC_Count];
+
+// std allocator that accounts its elements to category C
+template <typename T, MemCategory C>
+struct CountingAllocator
+{
+    using value_type = T;
+    template <typename U>
+    struct rebind
+    {
+        using other = CountingAllocator<U, C>;
+    };
+
+    CountingAllocator() = default;
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U, C> &) {}
+
+    T *allocate(std::size_t n)
+    {
+        mem_counters[C].add(n * sizeof(T), n);
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T *p, std::size_t n)
+    {
+        mem_counters[C].sub(n * sizeof(T), n);
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U, C> &) const { return true; }
+    template <typename U>
+    bool operator!=(const CountingAllocator<U, C> &) const { return false; }
+};
+
+// Snapshots of every category, front end and IR, taken at the phase
+// boundaries when the driver asks for --mem-report.
+class MemReport
+{
+public:
+    void enable() { enabled = true; }
+    bool is_enabled() const { return enabled; }
+
+    // records the counters after phase, nothing when disabled
+    void snapshot(const char *phase);
+    void print(std::FILE *out) const;
+
+    // peak resident set size of the process in bytes, 0 if unknown
+    static std::size_t peak_rss();
+
+private:
+    struct Row
+    {
+        std::string category;
+        std::size_t bytes;
+        std::size_t objects;
+    };
+    struct Snapshot
+    {
+        const char *phase;
+        std::vector<Row> rows;
+        std::size_t peak_rss;
+    };
+
+    bool enabled = false;
+    std::vector<Snapshot> snapshots;
+};
+
+MemReport &mem_report();
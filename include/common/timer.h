@@ -0,0 +1,78 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Scoped wall/CPU timers of the compiler phases, the -ftime-report of
+// this compiler. Recording is off unless the driver enables it, then
+// a disabled TimeScope costs one test of a global flag. The front end
+// is single threaded, so is the recording.
+struct TimeEvent
+{
+    // key of the report table, a string literal
+    const char *name;
+    // e.g. the function being compiled, only kept in the trace
+    std::string detail;
+    int depth;
+    int64_t start_ns;
+    int64_t wall_ns;
+    int64_t cpu_ns;
+};
+
+class Timers
+{
+public:
+    Timers();
+
+    void enable() { enabled = true; }
+    bool is_enabled() const { return enabled; }
+
+    // opens an event nested in the open ones, returns its index
+    std::size_t begin(const char *name, std::string_view detail);
+    void end(std::size_t event);
+
+    // one row per name, in first seen order, time of nested names
+    // is also counted in the enclosing ones
+    void print_report(std::FILE *out) const;
+    // Chrome trace-event JSON, load it in chrome://tracing or Perfetto.
+    // returns false if the file cannot be written
+    bool write_trace(const std::string &path) const;
+
+    const std::vector<TimeEvent> &events() const { return recorded; }
+
+private:
+    int64_t wall_now() const;
+    static int64_t cpu_now();
+
+    bool enabled = false;
+    int depth = 0;
+    std::chrono::steady_clock::time_point epoch;
+    std::vector<TimeEvent> recorded;
+};
+
+Timers &timers();
+
+// times the enclosing scope under name, nothing when timing is off
+class TimeScope
+{
+public:
+    explicit TimeScope(const char *name, std::string_view detail = {})
+    {
+        if (timers().is_enabled())
+            event = timers().begin(name, detail);
+    }
+    ~TimeScope()
+    {
+        if (event != none)
+            timers().end(event);
+    }
+    TimeScope(const TimeScope &) = delete;
+    TimeScope &operator=(const TimeScope &) = delete;
+
+private:
+    static constexpr std::size_t none = SIZE_MAX;
+    std::size_t event = none;
+};
@@ -9,17 +9,34 @@ enum RightOp {
     NONE
 };
 
-void ir_translate(TreeRoot *root, string output_file="output.acc", bool debug=false);
-void ir(ExprPtr node, Table<varType>& varTable, Table<FuncType>& funcTable, 
-        Table<Value*>& allocaTavle, Table<Function*>& funcValueTable, Module* module);
+// state of one translation. Names were resolved by sa, so the slots are
+// indexed by symbol id: values holds the GlobalVariable, AllocaInst or
+// Argument of each var, functions the Function of each function.
+struct IRContext {
+    const std::vector<Symbol>& symbols;
+    std::vector<Value *> values;
+    std::vector<Function *> functions;
+    // "ret.addr" of the function being translated, nullptr if it is void
+    AllocaInst* ret_addr = nullptr;
+    Module* module;
+    // set when a statement cannot be translated
+    bool failed = false;
+
+    IRContext(const std::vector<Symbol>& symbols, Module* module)
+        : symbols(symbols), values(symbols.size(), nullptr), functions(symbols.size(), nullptr), module(module) {}
+};
+
+// writes the IR of root to output_file, threads format the functions in
+// parallel. returns 0 on success, -1 if a statement cannot be translated
+// or the file cannot be written
+int ir_translate(TreeRoot *root, string output_file="output.acc", bool debug=false, unsigned threads=1);
+void ir(TreeRoot *root, IRContext& ctx);
 
 FunctionType * translate_func_type(FuncType func_type);
 
-Value* translate_expr(ExprPtr expr, Table<varType>& varTable, Table<FuncType>& funcTable, Table<Value *>& allocaTable,
-                     Table<Function*>& funcValueTable, BasicBlock* current_bb, bool is_lhs=false);
-BasicBlock* translate_stmt(ExprPtr expr, Table<varType>& varTable, Table<FuncType>& funcTable, Table<Value *>& allocaTable,
-                        Table<Function*>& funcValueTable, BasicBlock* current_bb, bool inner_block=true);
+Value* translate_expr(ExprPtr expr, IRContext& ctx, BasicBlock* current_bb, bool is_lhs=false);
+BasicBlock* translate_stmt(ExprPtr expr, IRContext& ctx, BasicBlock* current_bb);
 BinaryInst::BinaryOps convertOpTypeToBinaryOps(OpType opType);
 void split_shortcut_expr(ExprPtr expr, vector<pair<ExprPtr, RightOp>>& split_exprs, RightOp rop);
-BasicBlock* translate_shortcut_expr(vector<pair<ExprPtr, RightOp>>& split_exprs, BasicBlock* true_bb, BasicBlock* false_bb, 
-    Table<varType>& varTable, Table<FuncType>& funcTable, Table<Value *>& allocaTable, Table<Function*>& funcValueTable);
\ No newline at end of file
+BasicBlock* translate_shortcut_expr(vector<pair<ExprPtr, RightOp>>& split_exprs, BasicBlock* true_bb, BasicBlock* false_bb,
+    IRContext& ctx);
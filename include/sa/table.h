@@ -0,0 +1,131 @@
+#pragma once
+#include "common/mem_stats.h"
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Maps every identifier to a small dense id, so the symbol tables can
+// index their scope chains by id instead of hashing strings per scope.
+// Open addressing with linear probing, the table is kept at most half full.
+class NameInterner {
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    // id of name, adding it if it is new
+    uint32_t intern(std::string_view name);
+    // id of name, npos if it was never interned
+    uint32_t find(std::string_view name) const;
+    std::string_view name(uint32_t id) const { return names[id]; }
+    std::size_t size() const { return names.size(); }
+
+private:
+    struct Slot {
+        uint32_t hash;
+        uint32_t id = npos;
+    };
+
+    static uint32_t hash_name(std::string_view name);
+    std::size_t probe(std::string_view name, uint32_t hash) const;
+    void grow();
+
+    std::vector<Slot, CountingAllocator<Slot, MC_Names>> slots;
+    // deque keeps the characters in place as names are added
+    std::deque<std::string, CountingAllocator<std::string, MC_Names>> names;
+};
+
+// names shared by every symbol table of the compiler
+NameInterner &symbol_names();
+
+// Scoped symbol table. All scopes share one entry stack; each name id
+// points at its innermost entry, which links to the entry it shadows.
+// The entry stack doubles as the undo log: quit_env pops the entries of
+// the closing scope and restores what they shadowed, so entering and
+// leaving a scope costs only the size of that scope.
+template<typename T>
+class Table {
+private:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    struct Entry {
+        T value;
+        uint32_t name;
+        uint32_t shadowed;
+    };
+
+    // deque: pushing and popping at the end keeps references stable
+    std::deque<Entry, CountingAllocator<Entry, MC_Table>> entries;
+    // entries.size() when each open scope was entered
+    std::vector<uint32_t, CountingAllocator<uint32_t, MC_Table>> scope_begin;
+    // name id -> innermost entry
+    std::vector<uint32_t, CountingAllocator<uint32_t, MC_Table>> heads;
+    std::string cur_func_name;
+
+public:
+    Table() = default;
+
+    void set_func_name(std::string_view x) {
+        cur_func_name = x;
+    }
+
+    const std::string& get_cur_func_name() const {
+        return cur_func_name;
+    }
+
+    // returns -1 if the name is already declared in the current scope
+    int add_one_entry(std::string_view entry_name, T entry_type) {
+        uint32_t name = symbol_names().intern(entry_name);
+        if (name >= heads.size())
+            heads.resize(symbol_names().size(), npos);
+        uint32_t head = heads[name];
+        if (head != npos && head >= scope_begin.back())
+            return -1;
+        entries.push_back({std::move(entry_type), name, head});
+        heads[name] = entries.size() - 1;
+        return 0;
+    }
+
+    void new_env() {
+        scope_begin.push_back(entries.size());
+    }
+
+    void quit_env() {
+        uint32_t begin = scope_begin.back();
+        scope_begin.pop_back();
+        while (entries.size() > begin) {
+            heads[entries.back().name] = entries.back().shadowed;
+            entries.pop_back();
+        }
+    }
+
+    // innermost visible entry, nullptr if none. The pointer stays valid
+    // until the scope declaring it is left.
+    T* lookup(std::string_view entry_name) {
+        uint32_t name = symbol_names().find(entry_name);
+        if (name >= heads.size() || heads[name] == npos)
+            return nullptr;
+        return &entries[heads[name]].value;
+    }
+
+    // entries of one open scope (0 is the outermost), in declaration order
+    std::vector<std::pair<std::string_view, T*>> scope_entries(std::size_t level) {
+        std::vector<std::pair<std::string_view, T*>> res;
+        std::size_t end = level + 1 < scope_begin.size() ? scope_begin[level + 1] : entries.size();
+        for (std::size_t i = scope_begin[level]; i < end; i++)
+            res.emplace_back(symbol_names().name(entries[i].name), &entries[i].value);
+        return res;
+    }
+
+    void print_table() {
+        std::cout << "table: " << std::endl;
+        for (std::size_t i = 0; i < scope_begin.size(); i++) {
+            std::cout << "env " << i << ": ";
+            for (auto &pair : scope_entries(i))
+                std::cout << pair.first << " ";
+            std::cout << std::endl;
+        }
+    }
+};
@@ -0,0 +1,55 @@
+#include "ast/arena.h"
+
+#include <cstdlib>
+
+void *AstArena::allocate(std::size_t size, std::size_t align)
+{
+    allocated += size;
+    mem_counters[MC_AST].bytes += size;
+    std::uintptr_t p = (reinterpret_cast<std::uintptr_t>(cur) + align - 1) & ~(std::uintptr_t)(align - 1);
+    if (cur != nullptr && p + size <= reinterpret_cast<std::uintptr_t>(end))
+    {
+        cur = reinterpret_cast<char *>(p + size);
+        return reinterpret_cast<void *>(p);
+    }
+    // big requests get a slab of their own, so the current one is kept
+    if (size + align > slab_size / 2)
+    {
+        char *slab = static_cast<char *>(std::malloc(size + align));
+        if (slab == nullptr)
+            throw std::bad_alloc();
+        slabs.push_back(slab);
+        p = (reinterpret_cast<std::uintptr_t>(slab) + align - 1) & ~(std::uintptr_t)(align - 1);
+        return reinterpret_cast<void *>(p);
+    }
+    char *slab = static_cast<char *>(std::malloc(slab_size));
+    if (slab == nullptr)
+        throw std::bad_alloc();
+    slabs.push_back(slab);
+    end = slab + slab_size;
+    p = (reinterpret_cast<std::uintptr_t>(slab) + align - 1) & ~(std::uintptr_t)(align - 1);
+    cur = reinterpret_cast<char *>(p + size);
+    return reinterpret_cast<void *>(p);
+}
+
+const char *AstArena::copy_string(const char *str, std::size_t len)
+{
+    char *s = allocate_array<char>(len + 1);
+    std::memcpy(s, str, len);
+    s[len] = '\0';
+    return s;
+}
+
+void AstArena::reset()
+{
+    for (auto it = cleanups.rbegin(); it != cleanups.rend(); ++it)
+        it->fn(it->obj);
+    cleanups.clear();
+    for (char *slab : slabs)
+        std::free(slab);
+    slabs.clear();
+    cur = end = nullptr;
+    mem_counters[MC_AST].sub(allocated, objects);
+    allocated = 0;
+    objects = 0;
+}
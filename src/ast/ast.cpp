@@ -1,4 +1,5 @@
 #include "ast/ast.h"
+#include "ast/visitor.h"
 
 #include <fmt/core.h>
 #include <cassert>
@@ -13,138 +14,92 @@ static std::string op_str(OpType op_type) {
     }
 }
 
-void print_expr(ExprPtr exp, std::string prefix, std::string ident,int dep) {
-    int rdn=rand()*rand();
-    assert(exp != nullptr);
-    fmt::print(prefix);
-    // if (auto *it=exp->as<TreeBlock*>()){
-    //     if (auto *it1=exp->as<TreeVarDecl*>()){
-    //         puts("ni ma si le");
-    //     }
-    // }
-    if (auto *bin_op = exp->as<TreeBinaryExpr *>()) {
+namespace {
+
+// prints one node per line, prefix goes before the node itself and
+// ident before each of its children
+class AstPrinter : public AstVisitor<AstPrinter, void, const std::string &, const std::string &> {
+public:
+    void print(ExprPtr exp, const std::string &prefix, const std::string &ident) {
+        assert(exp != nullptr);
+        fmt::print(prefix);
+        visit(exp, prefix, ident);
+    }
+
+    void visit_binary(TreeBinaryExpr *bin_op, const std::string &, const std::string &ident) {
         fmt::print("BinOp \"{}\"\n", op_str(bin_op->op));
-        print_expr(bin_op->lhs, ident + "├─ ", ident + "│  ",dep+1);
-        print_expr(bin_op->rhs, ident + "└─ ", ident + "   ",dep+1);
+        print(bin_op->lhs, ident + "├─ ", ident + "│  ");
+        print(bin_op->rhs, ident + "└─ ", ident + "   ");
     }
-    if (auto *un_op = exp->as<TreeUnaryExpr *>()) {
+    void visit_unary(TreeUnaryExpr *un_op, const std::string &, const std::string &ident) {
         fmt::print("UnOp \"{}\"\n", op_str(un_op->op));
-        print_expr(un_op->operand, ident + "└─ ", ident + "   ",dep+1);
+        print(un_op->operand, ident + "└─ ", ident + "   ");
     }
-    if (auto* lit = exp->as < TreeNumber*>()) {
+    void visit_number(TreeNumber *lit, const std::string &, const std::string &) {
         fmt::print("Int {}\n", lit->value);
     }
-    if (auto *it=exp->as<TreeAssignStmt*>()){
+    void visit_assign(TreeAssignStmt *it, const std::string &, const std::string &ident) {
         if (it->rhs!=nullptr){
             fmt::print("AssignStmt\n");
-            print_expr(it->lhs, ident + "├─ ", ident + "│  ",dep+1);
-            print_expr(it->rhs, ident + "└─ ", ident + "   ",dep+1);
+            print(it->lhs, ident + "├─ ", ident + "│  ");
+            print(it->rhs, ident + "└─ ", ident + "   ");
         }
         else {
-            print_expr(it->lhs,"","",dep+1);
+            print(it->lhs,"","");
         }
         //int a可能被认为是assignstmt a=ALL
     }
-    if (auto *it=exp->as<TreeIfStmt*>()){
+    void visit_if(TreeIfStmt *it, const std::string &prefix, const std::string &ident) {
         fmt::print("IfStmt\n");
-        print_expr(it->conditionExp,ident + "├─ ", ident + "│  ",dep+1);
-        print_expr(it->trueStmtNode,ident + "└─ ", ident + "   ",dep+1);
+        print(it->conditionExp,ident + "├─ ", ident + "│  ");
+        print(it->trueStmtNode,ident + "└─ ", ident + "   ");
         if (it->elseStmtNode!=nullptr){
             fmt::print(prefix);
             fmt::print("ElseStmt\n");
-            print_expr(it->elseStmtNode,ident + "└─ ", ident + "   ",dep+1);
+            print(it->elseStmtNode,ident + "└─ ", ident + "   ");
         }
     }
-    if (auto *it=exp->as<TreeWhileStmt*>()){
+    void visit_while(TreeWhileStmt *it, const std::string &, const std::string &ident) {
         fmt::print("WhileStmt\n");
-        print_expr(it->conditionExp,ident + "├─ ", ident + "│  ",dep+1);
-        print_expr(it->trueStmtNode,ident + "└─ ", ident + "   ",dep+1);
+        print(it->conditionExp,ident + "├─ ", ident + "│  ");
+        print(it->trueStmtNode,ident + "└─ ", ident + "   ");
     }
-    if (auto *it=exp->as<TreeReturnStmt*>()){
+    void visit_return(TreeReturnStmt *it, const std::string &, const std::string &ident) {
         fmt::print("ReturnStmt\n");
         if (it->returnExp!=nullptr)//void f(){return;}
-            print_expr(it->returnExp,ident + "└─ ", ident + "   ",dep+1);
+            print(it->returnExp,ident + "└─ ", ident + "   ");
     }
-    if (auto *it=exp->as<TreeFuncExpr*>()){
-        fmt::print("Call "+it->name+"\n");
+    void visit_call(TreeFuncExpr *it, const std::string &, const std::string &ident) {
+        fmt::print("Call {}\n", it->name);
         for (auto x:it->varNames)
-            print_expr(x,ident + "└─ ", ident + "   ",dep+1);
+            print(x,ident + "└─ ", ident + "   ");
     }
-    if (auto *it=exp->as<TreeVarExpr*>()){
-        fmt::print("ident "+it->name+"\n");
+    void visit_var(TreeVarExpr *it, const std::string &, const std::string &) {
+        fmt::print("ident {}\n", it->name);
     }
-    if (auto *it=exp->as<TreeRoot*>()){
-        // printf("time: %d\n",rdn);
-        // printf("%d\n",dep);
+    void visit_root(TreeRoot *it, const std::string &, const std::string &ident) {
         fmt::print("CompUnit\n");
-        // printf("TreeRoot size: %d\n",it->rootItems.size());
-        // auto it1=it->rootItems[0];
-        // if (it1->as<TreeVarDecl*>()) printf("TreeVarDecl\n");
-        // else if (it1->as<TreeBlock*>()) printf("Block\n");
-        int sz=it->rootItems.size();
-        for (int i=sz-1;~i;i--)
-            print_expr(it->rootItems[i],ident + "└─ ", ident + "   ",dep+1);
-        // for (auto it1:(it->rootItems))
-        //     print_expr(it1,ident + "└─ ", ident + "   ",dep+1);
+        for (auto x:it->rootItems)
+            print(x,ident + "└─ ", ident + "   ");
     }
-    if (auto *it=exp->as<TreeVarDecl*>()){
-        // printf("TreeVarDecl time: %d\n",rdn);
+    void visit_var_decl(TreeVarDecl *it, const std::string &, const std::string &ident) {
         fmt::print("VarDecl\n");
-        // printf("TreeValDecl size: %d\n",it->assignStmtNodes.size());
         for (auto x:it->assignStmtNodes)
-            print_expr(x,ident + "└─ ", ident + "   ",dep+1);
+            print(x,ident + "└─ ", ident + "   ");
     }
-    if (auto *it=exp->as<TreeBlock*>()){
-        // printf("Block time: %d\n",rdn);
-        // printf("%d\n",dep);
+    void visit_block(TreeBlock *it, const std::string &, const std::string &ident) {
         fmt::print("Block\n");
         for (auto x:it->blockItems)
-            print_expr(x,ident + "└─ ", ident + "   ",dep+1);
+            print(x,ident + "└─ ", ident + "   ");
     }
-    if (auto *it=exp->as<TreeFuncDef*>()){
+    void visit_func_def(TreeFuncDef *it, const std::string &, const std::string &ident) {
         fmt::print("FuncDef\n");
-        print_expr(it->blockNode,ident + "└─ ", ident + "   ",dep+1);
+        print(it->blockNode,ident + "└─ ", ident + "   ");
     }
-}
+};
 
-void free_ast(ExprPtr exp){
-    if (exp==nullptr) return;
-    if (auto *bin_op = exp->as<TreeBinaryExpr *>()) {
-        free_ast(bin_op->lhs);
-        free_ast(bin_op->rhs);
-    }
-    if (auto *un_op = exp->as<TreeUnaryExpr *>()) {
-        free_ast(un_op->operand);
-    }
-    if (auto *it=exp->as<TreeAssignStmt*>()){
-        free_ast(it->lhs);
-        free_ast(it->rhs);
-    }
-    if (auto *it=exp->as<TreeIfStmt*>()){
-        free_ast(it->conditionExp);
-        free_ast(it->trueStmtNode);
-        free_ast(it->elseStmtNode);
-    }
-    if (auto *it=exp->as<TreeWhileStmt*>()){
-        free_ast(it->conditionExp);
-        free_ast(it->trueStmtNode);
-    }
-    if (auto *it=exp->as<TreeReturnStmt*>()){
-        free_ast(it->returnExp);
-    }
-    if (auto *it=exp->as<TreeRoot*>()){
-        for (auto it1:(it->rootItems))
-            free_ast(it1);
-    }
-    if (auto *it=exp->as<TreeVarDecl*>()){
-        for (auto x:it->assignStmtNodes)
-            free_ast(x);
-    }
-    if (auto *it=exp->as<TreeBlock*>()){
-        for (auto x:it->blockItems)
-            free_ast(x);
-    }
-    if (auto *it=exp->as<TreeFuncDef*>())
-        free_ast(it->blockNode);
-    free(exp);
-}
\ No newline at end of file
+} // namespace
+
+void print_expr(ExprPtr exp, std::string prefix, std::string ident, int) {
+    AstPrinter().print(exp, prefix, ident);
+}
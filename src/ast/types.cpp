@@ -0,0 +1,88 @@
+#include "ast/types.h"
+
+#include <functional>
+
+TypeContext &type_context()
+{
+    static TypeContext context;
+    return context;
+}
+
+varType::varType(MyType type, int d)
+    : varType(type_context().get_var_type(type, std::vector<int>(d, 0)))
+{
+}
+
+varType::varType(MyType type, int d, std::vector<int> d_size)
+    : varType(type_context().get_var_type(type, std::move(d_size)))
+{
+}
+
+FuncType::FuncType(const std::vector<varType> &iT, MyType rT)
+    : FuncType(type_context().get_func_type(rT, iT))
+{
+}
+
+static std::size_t hash_combine(std::size_t seed, std::size_t v)
+{
+    return seed ^ (v + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+std::size_t TypeContext::VarHash::operator()(const VarTypeInfo *t) const
+{
+    std::size_t h = std::hash<int>()(t->type);
+    for (int size : t->dimension_size)
+        h = hash_combine(h, std::hash<int>()(size));
+    return hash_combine(h, t->dimension_size.size());
+}
+
+bool TypeContext::VarEq::operator()(const VarTypeInfo *a, const VarTypeInfo *b) const
+{
+    return a->type == b->type && a->dimension_size == b->dimension_size;
+}
+
+std::size_t TypeContext::FuncHash::operator()(const FuncTypeInfo *t) const
+{
+    std::size_t h = std::hash<int>()(t->returnType);
+    for (varType param : t->inputType)
+        h = hash_combine(h, std::hash<const VarTypeInfo *>()(&*param));
+    return hash_combine(h, t->inputType.size());
+}
+
+bool TypeContext::FuncEq::operator()(const FuncTypeInfo *a, const FuncTypeInfo *b) const
+{
+    // parameters are interned already, so this compares pointers
+    return a->returnType == b->returnType && a->inputType == b->inputType;
+}
+
+varType TypeContext::get_var_type(MyType type, std::vector<int> dimension_size)
+{
+    VarTypeInfo probe{type, (int)dimension_size.size(), std::move(dimension_size), varType()};
+    auto it = var_set.find(&probe);
+    if (it != var_set.end())
+        return varType(*it);
+    VarTypeInfo &info = var_types.emplace_back(std::move(probe));
+    var_set.insert(&info);
+    if (info.dimension == 0 || info.dimension_size[0] == 0)
+    {
+        info.decayed = varType(&info);
+    }
+    else
+    {
+        std::vector<int> decayed_size = info.dimension_size;
+        decayed_size[0] = 0;
+        info.decayed = get_var_type(type, std::move(decayed_size));
+    }
+    return varType(&info);
+}
+
+FuncType TypeContext::get_func_type(MyType return_type, std::vector<varType> input_type)
+{
+    FuncTypeInfo probe{std::move(input_type), return_type};
+    auto it = func_set.find(&probe);
+    if (it != func_set.end())
+        return FuncType(*it);
+    FuncTypeInfo &info = func_types.emplace_back(std::move(probe));
+    func_set.insert(&info);
+    return FuncType(&info);
+}
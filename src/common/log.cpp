@@ -0,0 +1,51 @@
+#include "common/log.h"
+
+#include <cstring>
+#include <string_view>
+
+LogLevel log_levels[LC_Count] = {
+#define LogCategoryDefine(x, s) LL_Warn,
+#include "common/common.def"
+};
+
+static const char *const category_names[] = {
+#define LogCategoryDefine(x, s) s,
+#include "common/common.def"
+};
+
+static const char *const level_names[] = {"error", "warn", "info", "debug", "trace"};
+
+void log_set_all(LogLevel level)
+{
+    for (auto &l : log_levels)
+        l = level;
+}
+
+bool log_configure(const char *spec)
+{
+    std::string_view s(spec);
+    std::string_view cat = s.substr(0, s.find(':'));
+    LogLevel level = LL_Trace;
+    if (cat.size() < s.size())
+    {
+        std::string_view name = s.substr(cat.size() + 1);
+        int i = 0;
+        while (i <= LL_Trace && name != level_names[i])
+            ++i;
+        if (i > LL_Trace)
+            return false;
+        level = static_cast<LogLevel>(i);
+    }
+    if (cat == "all")
+    {
+        log_set_all(level);
+        return true;
+    }
+    for (int i = 0; i < LC_Count; ++i)
+        if (cat == category_names[i])
+        {
+            log_levels[i] = level;
+            return true;
+        }
+    return false;
+}
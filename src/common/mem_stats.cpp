@@ -0,0 +1,77 @@
+#include "common/mem_stats.h"
+#include "utils/alloc_stats.h"
+
+#include <fmt/core.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+MemCounter mem_counters[MC_Count];
+
+static const char *const category_names[] = {
+#define MemCategoryDefine(x, s) s,
+#include "common/common.def"
+};
+
+MemReport &mem_report()
+{
+    static MemReport instance;
+    return instance;
+}
+
+std::size_t MemReport::peak_rss()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#if defined(__APPLE__)
+    return usage.ru_maxrss;
+#else
+    // kilobytes on Linux and the BSDs
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#endif
+#else
+    return 0;
+#endif
+}
+
+void MemReport::snapshot(const char *phase)
+{
+    if (!enabled)
+        return;
+    Snapshot snap{phase, {}, peak_rss()};
+    for (int i = 0; i < MC_Count; ++i)
+        snap.rows.push_back({category_names[i], mem_counters[i].bytes, mem_counters[i].objects});
+    for (unsigned i = 0; i < static_cast<unsigned>(AllocKind::NumKinds); ++i)
+    {
+        auto kind = static_cast<AllocKind>(i);
+        const AllocCounter &c = AllocStats::get(kind);
+        snap.rows.push_back({std::string("IR ") + AllocStats::getKindName(kind), c.Bytes, c.Objects});
+    }
+    snapshots.push_back(std::move(snap));
+}
+
+void MemReport::print(std::FILE *out) const
+{
+    fmt::print(out, "==={:-^60}===\n", "");
+    std::string_view title = "Memory report";
+    fmt::print(out, "{:{}}{}\n", "", (66 - title.size()) / 2, title);
+    fmt::print(out, "==={:-^60}===\n", "");
+    for (auto &snap : snapshots)
+    {
+        fmt::print(out, "  after {}:\n", snap.phase);
+        fmt::print(out, "    {:<20}  {:>12}  {:>9}\n", "category", "live bytes", "objects");
+        std::size_t total = 0;
+        for (auto &row : snap.rows)
+        {
+            total += row.bytes;
+            if (row.bytes == 0 && row.objects == 0)
+                continue;
+            fmt::print(out, "    {:<20}  {:>12}  {:>9}\n", row.category, row.bytes, row.objects);
+        }
+        fmt::print(out, "    {:<20}  {:>12}\n", "total", total);
+        fmt::print(out, "    {:<20}  {:>12}\n\n", "peak RSS", snap.peak_rss);
+    }
+}
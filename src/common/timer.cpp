@@ -0,0 +1,127 @@
+#include "common/timer.h"
+
+#include <ctime>
+#include <fmt/core.h>
+#include <unordered_map>
+
+Timers &timers()
+{
+    static Timers instance;
+    return instance;
+}
+
+Timers::Timers() : epoch(std::chrono::steady_clock::now()) {}
+
+int64_t Timers::wall_now() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+int64_t Timers::cpu_now()
+{
+    return static_cast<int64_t>(std::clock()) * (1000000000 / CLOCKS_PER_SEC);
+}
+
+std::size_t Timers::begin(const char *name, std::string_view detail)
+{
+    recorded.push_back({name, std::string(detail), depth++, 0, 0, 0});
+    // read the clocks last, so the push above is not timed
+    TimeEvent &e = recorded.back();
+    e.cpu_ns = cpu_now();
+    e.start_ns = wall_now();
+    return recorded.size() - 1;
+}
+
+void Timers::end(std::size_t event)
+{
+    int64_t wall = wall_now();
+    int64_t cpu = cpu_now();
+    TimeEvent &e = recorded[event];
+    e.wall_ns = wall - e.start_ns;
+    e.cpu_ns = cpu - e.cpu_ns;
+    --depth;
+}
+
+void Timers::print_report(std::FILE *out) const
+{
+    struct Row
+    {
+        const char *name;
+        int depth;
+        int64_t wall_ns = 0;
+        int64_t cpu_ns = 0;
+        int count = 0;
+    };
+    std::vector<Row> rows;
+    std::unordered_map<std::string_view, std::size_t> row_of;
+    int64_t total_wall = 0, total_cpu = 0;
+    for (auto &e : recorded)
+    {
+        auto [it, inserted] = row_of.emplace(e.name, rows.size());
+        if (inserted)
+            rows.push_back({e.name, e.depth});
+        Row &row = rows[it->second];
+        row.wall_ns += e.wall_ns;
+        row.cpu_ns += e.cpu_ns;
+        row.count++;
+        if (e.depth == 0)
+        {
+            total_wall += e.wall_ns;
+            total_cpu += e.cpu_ns;
+        }
+    }
+
+    fmt::print(out, "==={:-^60}===\n", "");
+    std::string_view title = "Compile time report";
+    fmt::print(out, "{:{}}{}\n", "", (66 - title.size()) / 2, title);
+    fmt::print(out, "==={:-^60}===\n", "");
+    fmt::print(out, "  Total: {:.3f} ms wall, {:.3f} ms cpu\n\n", total_wall / 1e6, total_cpu / 1e6);
+    fmt::print(out, "  {:>11}  {:>6}  {:>11}  {:>6}  {}\n", "wall (ms)", "wall %", "cpu (ms)", "count", "name");
+    for (auto &row : rows)
+    {
+        double percent = total_wall ? 100.0 * row.wall_ns / total_wall : 0.0;
+        fmt::print(out, "  {:>11.3f}  {:>5.1f}%  {:>11.3f}  {:>6}  {:{}}{}\n", row.wall_ns / 1e6, percent,
+                   row.cpu_ns / 1e6, row.count, "", 2 * row.depth, row.name);
+    }
+}
+
+static void write_json_string(std::FILE *out, std::string_view s)
+{
+    std::fputc('"', out);
+    for (char c : s)
+    {
+        if (c == '"' || c == '\\')
+            std::fputc('\\', out);
+        if (static_cast<unsigned char>(c) < 0x20)
+            fmt::print(out, "\\u{:04x}", c);
+        else
+            std::fputc(c, out);
+    }
+    std::fputc('"', out);
+}
+
+bool Timers::write_trace(const std::string &path) const
+{
+    std::FILE *out = std::fopen(path.c_str(), "w");
+    if (!out)
+        return false;
+    fmt::print(out, "{{\"traceEvents\":[\n");
+    for (std::size_t i = 0; i < recorded.size(); ++i)
+    {
+        const TimeEvent &e = recorded[i];
+        fmt::print(out, "{{\"name\":");
+        write_json_string(out, e.name);
+        // complete events, timestamps are in microseconds
+        fmt::print(out, ",\"cat\":\"compile\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":{:.3f},\"dur\":{:.3f}",
+                   e.start_ns / 1e3, e.wall_ns / 1e3);
+        fmt::print(out, ",\"args\":{{\"cpu_us\":{:.3f}", e.cpu_ns / 1e3);
+        if (!e.detail.empty())
+        {
+            fmt::print(out, ",\"detail\":");
+            write_json_string(out, e.detail);
+        }
+        fmt::print(out, "}}}}{}\n", i + 1 < recorded.size() ? "," : "");
+    }
+    fmt::print(out, "]}}\n");
+    return std::fclose(out) == 0;
+}
@@ -1,312 +1,300 @@
 #include "ir/ir.h"
 #include "sa/sa.h"
+#include "ast/visitor.h"
+#include "common/log.h"
+#include "common/timer.h"
+#include "common/mem_stats.h"
+#include <algorithm>
 #include <cassert>
 #include <fmt/core.h>
 #include <iostream>
-#include <fstream>
 #include <sstream>
 
-void ir_translate(TreeRoot *root, string output_file, bool debug) {
-    Table<varType> varTable;
-    Table<FuncType> funcTable;
-    Table<Value *> allocaTable;
-    Table<Function*> funcValueTable;
+int ir_translate(TreeRoot *root, string output_file, bool debug, unsigned threads) {
+    TimeScope timer("IR translate");
     Module* module = new Module();
-    ir(root, varTable, funcTable, allocaTable, funcValueTable, module);
-    std::ofstream outFile(output_file);
-    module->print(std::cout, debug); // for debug
-    module->print(outFile, debug);
-    outFile.close();
+    IRContext ctx(root->symbols, module);
+    ir(root, ctx);
+    if (ctx.failed)
+        return -1;
+    mem_report().snapshot("IR generation");
+    TimeScope print_timer("IR print");
+    if (!module->printToFile(output_file, debug, threads)) {
+        LOG_ERROR(LC_IRGen, "cannot write {}\n", output_file);
+        return -1;
+    }
+    // the stdout copy is a trace only, the file above is formatted once
+    if (log_enabled(LC_IRGen, LL_Debug))
+        module->print(std::cout, debug, threads);
+    return 0;
+}
+
+// elements of a var, 1 for scalars
+static size_t num_elements(varType type) {
+    size_t num = 1;
+    for (int size : type->dimension_size)
+        num *= size;
+    return num;
 }
 
-void ir(ExprPtr node, Table<varType>& varTable, Table<FuncType>& funcTable, Table<Value *>& allocaTable,
-        Table<Function*>& funcValueTable, Module* module) {
-
-    assert(node != nullptr);
-
-    // root node
-    if (auto *root = node->as<TreeRoot *>()) {
-
-        fmt::print("translating root\n");
-        varTable.new_env();
-        funcTable.new_env();
-        allocaTable.new_env();
-        funcValueTable.new_env();
-        funcTable.add_one_entry("getint", FuncType({}, INT));
-        funcTable.add_one_entry("getch", FuncType({}, INT));
-        funcTable.add_one_entry("getarray", FuncType({varType(INT, 1)}, INT));
-        funcTable.add_one_entry("putint", FuncType({varType(INT, 0)}, VOID));
-        funcTable.add_one_entry("putch", FuncType({varType(INT, 0)}, VOID));
-        funcTable.add_one_entry("putarray", FuncType({varType(INT, 0), varType(INT, 1)}, VOID));
-        funcTable.add_one_entry("starttime", FuncType({}, VOID));
-        funcTable.add_one_entry("stoptime", FuncType({}, VOID));
-
-        // create GlobalVariable Value
-        vector<ExprPtr> gVarAssign;
-        for (int i = root->rootItems.size() - 1; i >= 0; i--) {
-            if (auto *varDeclNode = root->rootItems[i]->as<TreeVarDecl *>()) {
-                for (int i = 0; i < varDeclNode->assignStmtNodes.size(); i++) {
-                    
-                    auto *assignStmtNode = varDeclNode->assignStmtNodes[i]->as<TreeAssignStmt *>();
-                    auto *varExpNode = assignStmtNode->lhs->as<TreeVarExpr *>();
-                    // add new var to now table.
-                    std::vector<int> dimension_size;
-                    int num_elements = 1;
-                    for (int i = 0; i < varExpNode->index.size(); i++) {
-                        auto *numberNode = varExpNode->index[i]->as<TreeNumber *>();
-                        dimension_size.push_back(numberNode->value);
-                        num_elements *= numberNode->value;
-                    }
-                    varTable.add_one_entry(varExpNode->name, varType(varDeclNode->type, 0, dimension_size));
-                    // Create global variable
-                    GlobalVariable *g_var = GlobalVariable::Create(Type::getIntegerTy(), num_elements, false, varExpNode->name, module);
-                    allocaTable.add_one_entry(varExpNode->name, g_var);
-                    gVarAssign.push_back(assignStmtNode);
-                }
+void ir(TreeRoot *root, IRContext& ctx) {
+
+    assert(root != nullptr);
+    TimeScope timer("IR generation");
+    Module* module = ctx.module;
+
+    LOG_DEBUG(LC_IRGen, "translating root\n");
+
+    // create GlobalVariable Value
+    vector<ExprPtr> gVarAssign;
+    for (auto *item : root->rootItems) {
+        if (auto *varDeclNode = item->as<TreeVarDecl *>()) {
+            for (auto *assign : varDeclNode->assignStmtNodes) {
+                auto *assignStmtNode = assign->as_unchecked<TreeAssignStmt *>();
+                auto *varExpNode = assignStmtNode->lhs->as_unchecked<TreeVarExpr *>();
+                // Create global variable
+                const Symbol& symbol = ctx.symbols[varExpNode->symbol];
+                GlobalVariable *g_var = GlobalVariable::Create(Type::getIntegerTy(), num_elements(symbol.var_type), false, varExpNode->name, module);
+                ctx.values[varExpNode->symbol] = g_var;
+                gVarAssign.push_back(assignStmtNode);
             }
         }
+    }
 
-        // create runtime Fucntion Value
-        auto func_map = funcTable.getTable()[0];
-        for (auto it = func_map.begin(); it != func_map.end(); it++) {
-            // the runtime function has external linkage
-            Function* function = Function::Create(translate_func_type(it->second), true, it->first, module);
-            funcValueTable.add_one_entry(it->first, function);
-        }
+    // create runtime Fucntion Value
+    // declared in name order
+    vector<uint32_t> runtime_funcs;
+    for (uint32_t id = 0; id < ctx.symbols.size(); id++)
+        if (ctx.symbols[id].external)
+            runtime_funcs.push_back(id);
+    std::sort(runtime_funcs.begin(), runtime_funcs.end(), [&](uint32_t a, uint32_t b) {
+        return ctx.symbols[a].name < ctx.symbols[b].name;
+    });
+    for (uint32_t id : runtime_funcs) {
+        // the runtime function has external linkage
+        const Symbol& symbol = ctx.symbols[id];
+        ctx.functions[id] = Function::Create(translate_func_type(symbol.func_type), true, symbol.name, module);
+    }
 
-        // create Function Value
-        for (int i = root->rootItems.size() - 1; i >= 0; i--) {
-            if (auto *funcDefNode = root->rootItems[i]->as<TreeFuncDef *>()) {
-                // add new func to now table
-                funcTable.add_one_entry(funcDefNode->funcName, funcDefNode->type);
-                Function* function = Function::Create(translate_func_type(funcDefNode->type), false, funcDefNode->funcName, module);
-                funcValueTable.add_one_entry(funcDefNode->funcName, function);
-                BasicBlock* entry_bb = BasicBlock::Create(function);
-                BasicBlock* ret_bb = BasicBlock::Create(function);
-                entry_bb->setName("entry");
-                ret_bb->setName("exit");
-                // rename
-                auto input_type = funcDefNode->input_params;
-                for (int i = 0; i < function->arg_size(); i++) {
-                    function->getArg(i)->setName(input_type[i].first);
-                    fmt::print("name {}\n", input_type[i].first);
-                }
+    // create Function Value
+    for (auto *item : root->rootItems) {
+        if (auto *funcDefNode = item->as<TreeFuncDef *>()) {
+            Function* function = Function::Create(translate_func_type(funcDefNode->type), false, funcDefNode->funcName, module);
+            ctx.functions[funcDefNode->symbol] = function;
+            BasicBlock* entry_bb = BasicBlock::Create(function);
+            BasicBlock* ret_bb = BasicBlock::Create(function);
+            entry_bb->setName("entry");
+            ret_bb->setName("exit");
+            // rename
+            auto& input_type = funcDefNode->input_params;
+            for (int i = 0; i < function->arg_size(); i++) {
+                function->getArg(i)->setName(input_type[i].first);
+                LOG_TRACE(LC_IRGen, "name {}\n", input_type[i].first);
             }
         }
+    }
 
-        // create global var's Store Instruction to main 
-        for (int i = 0; i < gVarAssign.size(); i++) {
-            if (Function* main_func = module->getFunction("main"))
-                translate_stmt(gVarAssign[i], varTable, funcTable, allocaTable, funcValueTable, &main_func->getEntryBlock());
+    // create global var's Store Instruction to main 
+    for (int i = 0; i < gVarAssign.size(); i++) {
+        if (Function* main_func = module->getFunction("main"))
+            translate_stmt(gVarAssign[i], ctx, &main_func->getEntryBlock());
+    }
+
+    // enter each function
+    for (auto *item : root->rootItems) { // items are kept in source order
+        auto *funcDefNode = item->as<TreeFuncDef *>();
+        if (funcDefNode == nullptr)
+            continue;
+
+        TimeScope func_timer("IR function", funcDefNode->funcName);
+        Function *function = ctx.functions[funcDefNode->symbol];
+
+        // create ret IR
+        ctx.ret_addr = nullptr;
+        if (funcDefNode->type->returnType != VOID) {
+            AllocaInst* alloca_inst = AllocaInst::Create(Type::getIntegerTy(), 1, &function->getEntryBlock());
+            alloca_inst->setName("ret.addr");
+            ctx.ret_addr = alloca_inst;
+            LoadInst* load_inst = LoadInst::Create(alloca_inst, &function->back());
+            RetInst::Create(load_inst, &function->back());
+        } else {
+            RetInst::Create(ConstantUnit::Create(), &function->back());
         }
 
-        // enter each function
-        for (int i = root->rootItems.size() - 1; i >= 0; i--) { // attention to the order
-            
-            if (auto *funcDefNode = root->rootItems[i]->as<TreeFuncDef *>()) {
-
-                varTable.new_env();
-                allocaTable.new_env();
-
-                Function *function = module->getFunction(funcDefNode->funcName);
-
-                // create ret IR
-                if (funcDefNode->type.returnType != VOID) {
-                    AllocaInst* alloca_inst = AllocaInst::Create(Type::getIntegerTy(), 1, &function->getEntryBlock());
-                    alloca_inst->setName("ret.addr");
-                    allocaTable.add_one_entry("ret", alloca_inst);
-                    LoadInst* load_inst = LoadInst::Create(alloca_inst, &function->back());
-                    RetInst::Create(load_inst, &function->back());
-                } else {
-                    RetInst::Create(ConstantUnit::Create(), &function->back());
-                }
-
-                // alloca and store for input params
-                for (int i = 0; i < funcDefNode->input_params.size(); i++) {
-                    auto inputParam = funcDefNode->input_params[i];
-                    varTable.add_one_entry(inputParam.first, inputParam.second);
-                    if (inputParam.second.dimension == 0) {
-                        AllocaInst* alloca_inst = AllocaInst::Create(Type::getIntegerTy(), 1, &function->getEntryBlock());
-                        alloca_inst->setName(inputParam.first + ".addr");
-                        allocaTable.add_one_entry(inputParam.first, alloca_inst);
-                        Argument* argument = function->getArg(i);
-                        StoreInst::Create(argument, alloca_inst, &function->getEntryBlock());
-                    } else {
-                        allocaTable.add_one_entry(inputParam.first, function->getArg(i));
-                    }
-                }
-
-                funcTable.set_func_name(funcDefNode->funcName);
-                // analysis block
-                translate_stmt(funcDefNode->blockNode, varTable, funcTable, allocaTable, funcValueTable, &function->getEntryBlock(), false);
-                
-                varTable.quit_env();
-                allocaTable.quit_env();
-
-                continue;
+        // alloca and store for input params
+        for (int i = 0; i < funcDefNode->input_params.size(); i++) {
+            auto& inputParam = funcDefNode->input_params[i];
+            uint32_t id = funcDefNode->first_param + i;
+            if (inputParam.second->dimension == 0) {
+                AllocaInst* alloca_inst = AllocaInst::Create(Type::getIntegerTy(), 1, &function->getEntryBlock());
+                alloca_inst->setName(std::string(inputParam.first) + ".addr");
+                ctx.values[id] = alloca_inst;
+                Argument* argument = function->getArg(i);
+                StoreInst::Create(argument, alloca_inst, &function->getEntryBlock());
+            } else {
+                ctx.values[id] = function->getArg(i);
             }
         }
 
-        // end ir
-        varTable.quit_env();
-        funcTable.quit_env();
-        allocaTable.quit_env();
-        funcValueTable.quit_env();
+        // analysis block
+        translate_stmt(funcDefNode->blockNode, ctx, &function->getEntryBlock());
     }
 }
 
-Value* translate_expr(ExprPtr expr, Table<varType>& varTable, Table<FuncType>& funcTable, Table<Value *>& allocaTable,
-                    Table<Function*>& funcValueTable, BasicBlock* current_bb, bool is_lhs) {
-    if (auto* number_exp = expr->as<TreeNumber*>()) {
-        fmt::print("translating number expr\n");
+namespace {
+
+// expression translation, the bool argument asks for the address of an
+// array element instead of its value
+class ExprTranslator : public AstVisitor<ExprTranslator, Value*, BasicBlock*, bool> {
+public:
+    explicit ExprTranslator(IRContext& ctx) : ctx(ctx) {}
+
+    Value* visit_default(ExprPtr, BasicBlock*, bool) {
+        return nullptr;
+    }
+
+    Value* visit_number(TreeNumber* number_exp, BasicBlock*, bool) {
+        LOG_TRACE(LC_IRGen, "translating number expr\n");
         uint32_t number = number_exp->value;
         return ConstantInt::Create(number);
     }
 
-    if (auto* var_exp = expr->as<TreeVarExpr*>()) {
-        fmt::print("translating var expr\n");
-        vector<ExprPtr> indices_expr = var_exp->index;
+    Value* visit_var(TreeVarExpr* var_exp, BasicBlock* current_bb, bool is_lhs) {
+        LOG_TRACE(LC_IRGen, "translating var expr\n");
+        const AstList<ExprPtr>& indices_expr = var_exp->index;
+        Value* lookup_res = ctx.values[var_exp->symbol];
+        varType var_type = ctx.symbols[var_exp->symbol].var_type;
 
         if (indices_expr.size() == 0) {
-            Value* lookup_res = *(allocaTable.lookup(var_exp->name));
-            varType lookup_type = *(varTable.lookup(var_exp->name));
             if (GlobalVariable* global_var = dyn_cast<GlobalVariable>(lookup_res)) {
-                if (lookup_type.dimension == 0)
+                if (var_type->dimension == 0)
                     return LoadInst::Create(global_var, current_bb);
                 else
                     return global_var;
             }
             if (AllocaInst* local_var = dyn_cast<AllocaInst>(lookup_res)) {
-                if (lookup_type.dimension == 0)
+                if (var_type->dimension == 0)
                     return LoadInst::Create(local_var, current_bb);
                 else
                     return local_var;
             }
             if (Argument* argument_var = dyn_cast<Argument>(lookup_res)) {
-                if (lookup_type.dimension == 0)
+                if (var_type->dimension == 0)
                     return LoadInst::Create(argument_var, current_bb);
                 else
                     return argument_var;
             }
-        
-        } else {
-            vector<Value*> indices;
-            vector<optional<size_t>> bounds;
-            varType var_type = *varTable.lookup(var_exp->name);
-            for (int i = 0; i < var_type.dimension_size.size(); i++) {
-                if (i < indices_expr.size())
-                    indices.push_back(translate_expr(indices_expr[i], varTable, funcTable, allocaTable, funcValueTable, current_bb));
-                else
-                    indices.push_back(ConstantInt::Create(0));
+            return nullptr;
+        }
 
-                if (var_type.dimension_size[i] == 0)
-                    bounds.push_back(nullopt);
-                else
-                    bounds.push_back((size_t)var_type.dimension_size[i]);
-            }
-            Value* lookup_res = *(allocaTable.lookup(var_exp->name));
-            OffsetInst* offset_inst;
-            if (GlobalVariable* global_var = dyn_cast<GlobalVariable>(lookup_res))
-                offset_inst = OffsetInst::Create(Type::getIntegerTy(), global_var, indices, bounds, current_bb);
-            if (AllocaInst* local_var = dyn_cast<AllocaInst>(lookup_res))
-                offset_inst = OffsetInst::Create(Type::getIntegerTy(), local_var, indices, bounds, current_bb);
-            if (Argument* argument = dyn_cast<Argument>(lookup_res))
-                offset_inst = OffsetInst::Create(Type::getIntegerTy(), argument, indices, bounds, current_bb);
-            if (is_lhs)
-                return offset_inst;
-            return LoadInst::Create(offset_inst, current_bb);
+        vector<Value*> indices;
+        vector<optional<size_t>> bounds;
+        for (int i = 0; i < var_type->dimension_size.size(); i++) {
+            if (i < indices_expr.size())
+                indices.push_back(visit(indices_expr[i], current_bb, false));
+            else
+                indices.push_back(ConstantInt::Create(0));
+
+            if (var_type->dimension_size[i] == 0)
+                bounds.push_back(nullopt);
+            else
+                bounds.push_back((size_t)var_type->dimension_size[i]);
         }
+        OffsetInst* offset_inst;
+        if (GlobalVariable* global_var = dyn_cast<GlobalVariable>(lookup_res))
+            offset_inst = OffsetInst::Create(Type::getIntegerTy(), global_var, indices, bounds, current_bb);
+        if (AllocaInst* local_var = dyn_cast<AllocaInst>(lookup_res))
+            offset_inst = OffsetInst::Create(Type::getIntegerTy(), local_var, indices, bounds, current_bb);
+        if (Argument* argument = dyn_cast<Argument>(lookup_res))
+            offset_inst = OffsetInst::Create(Type::getIntegerTy(), argument, indices, bounds, current_bb);
+        if (is_lhs)
+            return offset_inst;
+        return LoadInst::Create(offset_inst, current_bb);
     }
 
-    if (auto* binary_exp = expr->as<TreeBinaryExpr*>()) {
-        fmt::print("translating binary expr\n");
-        auto* expr_lhs = translate_expr(binary_exp->lhs, varTable, funcTable, allocaTable, funcValueTable, current_bb);
-        auto* expr_rhs = translate_expr(binary_exp->rhs, varTable, funcTable, allocaTable, funcValueTable, current_bb);
+    Value* visit_binary(TreeBinaryExpr* binary_exp, BasicBlock* current_bb, bool) {
+        LOG_TRACE(LC_IRGen, "translating binary expr\n");
+        auto* expr_lhs = visit(binary_exp->lhs, current_bb, false);
+        auto* expr_rhs = visit(binary_exp->rhs, current_bb, false);
         return BinaryInst::Create(convertOpTypeToBinaryOps(binary_exp->op), expr_lhs, expr_rhs, Type::getIntegerTy(), current_bb);
     }
 
-    if (auto* unary_exp = expr->as<TreeUnaryExpr*>()) {
-        fmt::print("translating unary expr\n");
+    Value* visit_unary(TreeUnaryExpr* unary_exp, BasicBlock* current_bb, bool) {
+        LOG_TRACE(LC_IRGen, "translating unary expr\n");
         auto* expr_zero = ConstantInt::Create(0);
-        auto* expr = translate_expr(unary_exp->operand, varTable, funcTable, allocaTable, funcValueTable, current_bb);
+        auto* expr = visit(unary_exp->operand, current_bb, false);
         return BinaryInst::Create(convertOpTypeToBinaryOps(unary_exp->op), expr_zero, expr, Type::getIntegerTy(), current_bb);
     }
 
-    if (auto* func_exp = expr->as<TreeFuncExpr*>()) {
-        fmt::print("translating function expr\n");
-        Function* function = *funcValueTable.lookup(func_exp->name);
+    Value* visit_call(TreeFuncExpr* func_exp, BasicBlock* current_bb, bool) {
+        LOG_TRACE(LC_IRGen, "translating function expr\n");
+        Function* function = ctx.functions[func_exp->symbol];
         vector<Value*> arguments;
         // varNames is actully the vector of the exprs, just forget to change the name (x
         for (int i = 0; i < func_exp->varNames.size(); i++) {
             // scalar
             if (function->getArg(i)->getType() == Type::getIntegerTy())
-                arguments.push_back(translate_expr(func_exp->varNames[i], varTable, funcTable, allocaTable, funcValueTable, current_bb));
+                arguments.push_back(visit(func_exp->varNames[i], current_bb, false));
             // array
             else
-                arguments.push_back(translate_expr(func_exp->varNames[i], varTable, funcTable, allocaTable, funcValueTable, current_bb, true));
+                arguments.push_back(visit(func_exp->varNames[i], current_bb, true));
         }
         return CallInst::Create(function, arguments, current_bb);
     }
-}
 
-BasicBlock* translate_stmt(ExprPtr expr, Table<varType>& varTable, Table<FuncType>& funcTable, Table<Value *>& allocaTable, 
-                            Table<Function*>& funcValueTable, BasicBlock* current_bb, bool inner_block) {
-    // block
-    if (auto *blockNode = expr->as<TreeBlock *>()) {
-        fmt::print("translating block\n");
-        // enter new env
-        if (inner_block) {
-            varTable.new_env();
-            allocaTable.new_env();
-        }
+private:
+    IRContext& ctx;
+};
+
+// statement translation, returns the block where control continues or
+// nullptr after a return
+class StmtTranslator : public AstVisitor<StmtTranslator, BasicBlock*, BasicBlock*> {
+public:
+    explicit StmtTranslator(IRContext& ctx) : ctx(ctx), expr(ctx) {}
+
+    // the root and function definitions are not statements
+    BasicBlock* visit_default(ExprPtr node, BasicBlock*) {
+        LOG_ERROR(LC_IRGen, "fail: node type {} is not a statement\n", static_cast<int>(node->node_type));
+        ctx.failed = true;
+        return nullptr;
+    }
 
+    // block
+    BasicBlock* visit_block(TreeBlock *blockNode, BasicBlock* current_bb) {
+        LOG_TRACE(LC_IRGen, "translating block\n");
         // may have no Decl or Stmt
-        for (int i = 0; i < blockNode->blockItems.size(); i++) {
-            current_bb = translate_stmt(blockNode->blockItems[i], varTable, funcTable, allocaTable, funcValueTable, current_bb);
+        for (auto *item : blockNode->blockItems) {
+            current_bb = visit(item, current_bb);
             if(current_bb == nullptr)
                 break;
         }
-
-        // quit env
-        if (inner_block) {
-            varTable.quit_env();
-            allocaTable.quit_env();
-        }
         return current_bb;
     }
 
     // var decl
-    if (auto *varDeclNode = expr->as<TreeVarDecl *>()) {
-        fmt::print("translating varDel\n");
-        for (int i = 0; i < varDeclNode->assignStmtNodes.size(); i++) {
-            auto *assignStmtNode = varDeclNode->assignStmtNodes[i]->as<TreeAssignStmt *>();
-            auto *varExpNode = assignStmtNode->lhs->as<TreeVarExpr *>();
-            size_t num_element = 1;
-            std::vector<int> dimension_size;
-            for (int i = 0; i < varExpNode->index.size(); i++) {
-                auto *numberNode = varExpNode->index[i]->as<TreeNumber *>();
-                dimension_size.push_back(numberNode->value);
-                num_element *= numberNode->value;
-            }
-            varTable.add_one_entry(varExpNode->name, varType(varDeclNode->type, 0, dimension_size));
-
+    BasicBlock* visit_var_decl(TreeVarDecl *varDeclNode, BasicBlock* current_bb) {
+        LOG_TRACE(LC_IRGen, "translating varDel\n");
+        for (auto *assign : varDeclNode->assignStmtNodes) {
+            auto *assignStmtNode = assign->as_unchecked<TreeAssignStmt *>();
+            auto *varExpNode = assignStmtNode->lhs->as_unchecked<TreeVarExpr *>();
+            size_t num_element = num_elements(ctx.symbols[varExpNode->symbol].var_type);
             AllocaInst* alloca_inst = AllocaInst::Create(Type::getIntegerTy(), num_element, &current_bb->getParent()->getEntryBlock().back());
-            allocaTable.add_one_entry(varExpNode->name, alloca_inst);
-            current_bb = translate_stmt(assignStmtNode, varTable, funcTable, allocaTable, funcValueTable, current_bb);
+            ctx.values[varExpNode->symbol] = alloca_inst;
+            current_bb = visit_assign(assignStmtNode, current_bb);
         }
         return current_bb;
-    }   
+    }
 
     // assign statement
-    if (auto* assign_stmt = expr->as<TreeAssignStmt *>()) {
-        auto* varExpNode = assign_stmt->lhs->as<TreeVarExpr *>();
-        fmt::print("translating assign stmt: " + varExpNode->name + "\n");
+    BasicBlock* visit_assign(TreeAssignStmt* assign_stmt, BasicBlock* current_bb) {
+        auto* varExpNode = assign_stmt->lhs->as_unchecked<TreeVarExpr *>();
+        LOG_TRACE(LC_IRGen, "translating assign stmt: {}\n", varExpNode->name);
         if (assign_stmt->rhs == nullptr)
             return current_bb;
         // don't need offset for left var
         if (varExpNode->index.size() == 0) {
-            Value* lookup_res = *(allocaTable.lookup(varExpNode->name)); // left var
-            auto* result_value = translate_expr(assign_stmt->rhs, varTable, funcTable, allocaTable, funcValueTable, current_bb, false);
+            Value* lookup_res = ctx.values[varExpNode->symbol]; // left var
+            auto* result_value = expr.visit(assign_stmt->rhs, current_bb, false);
             if (GlobalVariable* global_var = dyn_cast<GlobalVariable>(lookup_res))
                 StoreInst::Create(result_value, global_var, current_bb);
             if (AllocaInst* local_var = dyn_cast<AllocaInst>(lookup_res))
@@ -316,91 +304,119 @@ BasicBlock* translate_stmt(ExprPtr expr, Table<varType>& varTable, Table<FuncTyp
             return current_bb;
         // need offset for left var
         } else {
-            auto* left_value = translate_expr(varExpNode, varTable, funcTable, allocaTable, funcValueTable, current_bb, true);
-            auto* result_value = translate_expr(assign_stmt->rhs, varTable, funcTable, allocaTable, funcValueTable, current_bb, false);
+            auto* left_value = expr.visit(varExpNode, current_bb, true);
+            auto* result_value = expr.visit(assign_stmt->rhs, current_bb, false);
             StoreInst::Create(result_value, left_value, current_bb);
-            return current_bb;         
+            return current_bb;
         }
     }
 
     // if statement
-    if (auto* if_stmt = expr->as<TreeIfStmt*>()) {
-        fmt::print("translating if stmt\n");
+    BasicBlock* visit_if(TreeIfStmt* if_stmt, BasicBlock* current_bb) {
+        LOG_TRACE(LC_IRGen, "translating if stmt\n");
         Function* function = current_bb->getParent();
-        // auto* cond_value = translate_expr(if_stmt->conditionExp, varTable, funcTable, allocaTable, funcValueTable, current_bb);
         vector<pair<ExprPtr, RightOp>> split_exprs;
         if (if_stmt->elseStmtNode == nullptr) {
-            BasicBlock* true_bb = BasicBlock::Create(function, &function->back());  
-            BasicBlock* exit_bb = BasicBlock::Create(function, &function->back());  
-            // BranchInst::Create(true_bb, exit_bb, cond_value, current_bb);
+            BasicBlock* true_bb = BasicBlock::Create(function, &function->back());
+            BasicBlock* exit_bb = BasicBlock::Create(function, &function->back());
             split_shortcut_expr(if_stmt->conditionExp, split_exprs, NONE);
-            BasicBlock* first_cond_bb = translate_shortcut_expr(split_exprs, true_bb, exit_bb, varTable, funcTable, allocaTable, funcValueTable);
+            BasicBlock* first_cond_bb = translate_shortcut_expr(split_exprs, true_bb, exit_bb, ctx);
             JumpInst::Create(first_cond_bb, current_bb);
 
-            BasicBlock* true_exit_bb = translate_stmt(if_stmt->trueStmtNode, varTable, funcTable, allocaTable, funcValueTable, true_bb);
-            if (true_exit_bb != nullptr) // don't have return 
+            BasicBlock* true_exit_bb = visit(if_stmt->trueStmtNode, true_bb);
+            if (true_exit_bb != nullptr) // don't have return
                 JumpInst::Create(exit_bb, true_exit_bb);
             return exit_bb;
         } else {
             BasicBlock* true_bb = BasicBlock::Create(function, &function->back());
             BasicBlock* false_bb = BasicBlock::Create(function, &function->back());
             BasicBlock* exit_bb = BasicBlock::Create(function, &function->back());
-            // BranchInst::Create(true_bb, false_bb, cond_value, current_bb);
             split_shortcut_expr(if_stmt->conditionExp, split_exprs, NONE);
-            BasicBlock* first_cond_bb = translate_shortcut_expr(split_exprs, true_bb, false_bb, varTable, funcTable, allocaTable, funcValueTable);
+            BasicBlock* first_cond_bb = translate_shortcut_expr(split_exprs, true_bb, false_bb, ctx);
             JumpInst::Create(first_cond_bb, current_bb);
 
-            BasicBlock* true_exit_bb = translate_stmt(if_stmt->trueStmtNode, varTable, funcTable, allocaTable, funcValueTable, true_bb);
+            BasicBlock* true_exit_bb = visit(if_stmt->trueStmtNode, true_bb);
             if (true_exit_bb != nullptr)
                 JumpInst::Create(exit_bb, true_exit_bb);
-            BasicBlock* false_exit_bb = translate_stmt(if_stmt->elseStmtNode, varTable, funcTable, allocaTable, funcValueTable, false_bb);
+            BasicBlock* false_exit_bb = visit(if_stmt->elseStmtNode, false_bb);
             if (false_exit_bb != nullptr)
-                JumpInst::Create(exit_bb, false_exit_bb); 
-            return exit_bb;       
+                JumpInst::Create(exit_bb, false_exit_bb);
+            return exit_bb;
         }
     }
 
     // while statement
-    if (auto* while_stmt = expr->as<TreeWhileStmt*>()) {
-        fmt::print("translating while stmt\n");
+    BasicBlock* visit_while(TreeWhileStmt* while_stmt, BasicBlock* current_bb) {
+        LOG_TRACE(LC_IRGen, "translating while stmt\n");
         Function* function = current_bb->getParent();
-        // BasicBlock* cond_bb = BasicBlock::Create(function, &function->back());  
-        BasicBlock* body_bb = BasicBlock::Create(function, &function->back());  
-        BasicBlock* exit_bb = BasicBlock::Create(function, &function->back());  
-        // JumpInst::Create(cond_bb, current_bb);
-        // auto* cond_value = translate_expr(while_stmt->conditionExp, varTable, funcTable, allocaTable, funcValueTable, cond_bb);
-        // BranchInst::Create(body_bb, exit_bb, cond_value, cond_bb);
+        BasicBlock* body_bb = BasicBlock::Create(function, &function->back());
+        BasicBlock* exit_bb = BasicBlock::Create(function, &function->back());
         vector<pair<ExprPtr, RightOp>> split_exprs;
         split_shortcut_expr(while_stmt->conditionExp, split_exprs, NONE);
-        BasicBlock* first_cond_bb = translate_shortcut_expr(split_exprs, body_bb, exit_bb, varTable, funcTable, allocaTable, funcValueTable);
+        BasicBlock* first_cond_bb = translate_shortcut_expr(split_exprs, body_bb, exit_bb, ctx);
         JumpInst::Create(first_cond_bb, current_bb);
 
-        BasicBlock* body_exit_bb = translate_stmt(while_stmt->trueStmtNode, varTable, funcTable, allocaTable, funcValueTable, body_bb);
+        loops.push_back({exit_bb, first_cond_bb});
+        BasicBlock* body_exit_bb = visit(while_stmt->trueStmtNode, body_bb);
+        loops.pop_back();
         if (body_exit_bb != nullptr)
-            // JumpInst::Create(cond_bb, body_exit_bb);
             JumpInst::Create(first_cond_bb, body_exit_bb);
         return exit_bb;
     }
 
+    // break and continue jump to the exit or the first condition block of
+    // the innermost loop
+    BasicBlock* visit_loop_control(TreeWhileControlStmt* control_stmt, BasicBlock* current_bb) {
+        LOG_TRACE(LC_IRGen, "translating {} stmt\n", control_stmt->controlType);
+        if (loops.empty()) {
+            LOG_ERROR(LC_IRGen, "fail: {} outside of a loop\n", control_stmt->controlType);
+            ctx.failed = true;
+            return nullptr;
+        }
+        auto [exit_bb, cond_bb] = loops.back();
+        JumpInst::Create(control_stmt->controlType == "Break" ? exit_bb : cond_bb, current_bb);
+        return nullptr;
+    }
+
     // return stmt
-    if (auto* return_stmt = expr->as<TreeReturnStmt*>()) {
-        fmt::print("translating return stmt\n");
+    BasicBlock* visit_return(TreeReturnStmt* return_stmt, BasicBlock* current_bb) {
+        LOG_TRACE(LC_IRGen, "translating return stmt\n");
         BasicBlock* ret_bb = &current_bb->getParent()->back();
         if (return_stmt->returnExp != nullptr) {
-            AllocaInst* ret_alloca = dyn_cast<AllocaInst>(*allocaTable.lookup("ret"));
-            auto* ret_value = translate_expr(return_stmt->returnExp, varTable, funcTable, allocaTable, funcValueTable, current_bb);
-            StoreInst::Create(ret_value, ret_alloca, current_bb);
+            auto* ret_value = expr.visit(return_stmt->returnExp, current_bb, false);
+            StoreInst::Create(ret_value, ctx.ret_addr, current_bb);
         }
         JumpInst::Create(ret_bb, current_bb);
         return nullptr;
     }
 
     // exp
-    if (expr->is<TreeUnaryExpr*>() || expr->is<TreeBinaryExpr*>() || expr->is<TreeVarExpr*>() || 
-        expr->is<TreeFuncExpr*>() || expr->is<TreeNumber*>()) {
-        translate_expr(expr, varTable, funcTable, allocaTable, funcValueTable, current_bb);
+    BasicBlock* visit_unary(TreeUnaryExpr* e, BasicBlock* current_bb) { return expr_stmt(e, current_bb); }
+    BasicBlock* visit_binary(TreeBinaryExpr* e, BasicBlock* current_bb) { return expr_stmt(e, current_bb); }
+    BasicBlock* visit_var(TreeVarExpr* e, BasicBlock* current_bb) { return expr_stmt(e, current_bb); }
+    BasicBlock* visit_call(TreeFuncExpr* e, BasicBlock* current_bb) { return expr_stmt(e, current_bb); }
+    BasicBlock* visit_number(TreeNumber* e, BasicBlock* current_bb) { return expr_stmt(e, current_bb); }
+
+private:
+    BasicBlock* expr_stmt(ExprPtr e, BasicBlock* current_bb) {
+        expr.visit(e, current_bb, false);
         return current_bb;
     }
+
+    IRContext& ctx;
+    ExprTranslator expr;
+    // (exit, first condition) blocks of the enclosing loops
+    vector<pair<BasicBlock*, BasicBlock*>> loops;
+};
+
+} // namespace
+
+Value* translate_expr(ExprPtr expr, IRContext& ctx, BasicBlock* current_bb, bool is_lhs) {
+    return ExprTranslator(ctx).visit(expr, current_bb, is_lhs);
+}
+
+BasicBlock* translate_stmt(ExprPtr expr, IRContext& ctx, BasicBlock* current_bb) {
+    return StmtTranslator(ctx).visit(expr, current_bb);
 }
 
 
@@ -426,14 +442,14 @@ void split_shortcut_expr(ExprPtr expr, vector<pair<ExprPtr, RightOp>>& split_exp
 
 
 BasicBlock* translate_shortcut_expr(vector<pair<ExprPtr, RightOp>>& split_exprs, BasicBlock* final_true_bb, BasicBlock* final_false_bb, 
-    Table<varType>& varTable, Table<FuncType>& funcTable, Table<Value *>& allocaTable, Table<Function*>& funcValueTable) {
+    IRContext& ctx) {
     vector<BasicBlock*> bbs;
     for (int i = 0; i < split_exprs.size(); i++)
         bbs.push_back(BasicBlock::Create(final_true_bb->getParent(), final_true_bb));
     BasicBlock* true_bb = final_true_bb;
     BasicBlock* false_bb = final_false_bb;
     for (int i = split_exprs.size()-1; i >= 0; i--) {
-        auto* cond_value = translate_expr(split_exprs[i].first, varTable, funcTable, allocaTable, funcValueTable, bbs[i]);
+        auto* cond_value = translate_expr(split_exprs[i].first, ctx, bbs[i]);
 
         if (split_exprs[i].second == NONE) {
             BranchInst::Create(true_bb, false_bb, cond_value, bbs[i]);
@@ -455,13 +471,13 @@ BasicBlock* translate_shortcut_expr(vector<pair<ExprPtr, RightOp>>& split_exprs,
 // translate FuncType to FunctionType*
 FunctionType * translate_func_type(FuncType func_type) {
     Type *ret_type;
-    if (func_type.returnType == VOID)
+    if (func_type->returnType == VOID)
         ret_type = Type::getUnitTy();
     else
         ret_type = Type::getIntegerTy();
     std::vector<Type *> params;
-    for (int i = 0; i < func_type.inputType.size(); i++) {
-        if (func_type.inputType[i].dimension == 0)
+    for (int i = 0; i < func_type->inputType.size(); i++) {
+        if (func_type->inputType[i]->dimension == 0)
             params.push_back(Type::getIntegerTy());
         else
             params.push_back(PointerType::get(Type::getIntegerTy()));
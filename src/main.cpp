@@ -1,28 +1,103 @@
 #include "ast/ast.h"
 #include "sa/sa.h"
 #include "ir/ir.h"
+#include "common/log.h"
+#include "common/timer.h"
+#include "common/mem_stats.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include <fmt/core.h>
 
 extern int yyparse();
 
 TreeRoot *root;
+AstArena *ast_arena;
 extern FILE *yyin;
 // extern int semantic_analysis(TreeRoot *root);
 
+namespace
+{
+
+// prints the reports asked for on the command line once main returns
+struct Reports
+{
+    bool table = false;
+    std::string trace_file;
+    bool memory = false;
+
+    ~Reports()
+    {
+        if (memory)
+            mem_report().print(stderr);
+        if (table)
+            timers().print_report(stderr);
+        if (!trace_file.empty() && !timers().write_trace(trace_file))
+            fmt::print(stderr, "cannot write {}\n", trace_file);
+    }
+};
+
+} // namespace
+
 int main(int argc, char **argv)
 {
+    // --log=<category>[:<level>]: trace a stage, e.g. --log=sema:debug,
+    //     --log=all prints everything the stages used to print
+    // -v: same as --log=all
+    // -j<N>: print the IR of N functions at a time
+    // --time-report: time of each phase on stderr
+    // --time-trace=<file>: the same as Chrome trace-event JSON
+    // --mem-report: live memory by category after each phase on stderr
+    unsigned ir_threads = 1;
+    Reports reports;
+    for (int i = 3; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--time-report") == 0)
+            reports.table = true;
+        else if (std::strncmp(argv[i], "--time-trace=", 13) == 0)
+            reports.trace_file = argv[i] + 13;
+        else if (std::strcmp(argv[i], "--mem-report") == 0)
+            reports.memory = true;
+        else if (std::strncmp(argv[i], "-j", 2) == 0)
+            ir_threads = std::max(1, std::atoi(argv[i] + 2));
+        else if (std::strcmp(argv[i], "-v") == 0)
+            log_set_all(LL_Trace);
+        else if (std::strncmp(argv[i], "--log=", 6) == 0)
+        {
+            if (!log_configure(argv[i] + 6))
+            {
+                fmt::print(stderr, "unknown log option: {}\n", argv[i]);
+                return 1;
+            }
+        }
+    }
+    if (reports.table || !reports.trace_file.empty())
+        timers().enable();
+    if (reports.memory)
+        mem_report().enable();
+    TimeScope timer("compile");
     yyin = fopen(argv[1], "r");
-    fmt::print("Start parsing!\n");
-    root = new TreeRoot(std::vector<ExprPtr>{});
-    int result = yyparse();
+    LOG_INFO(LC_Driver, "Start parsing!\n");
+    // owns the whole AST, released at once when main returns
+    AstArena arena;
+    ast_arena = &arena;
+    root = arena.make<TreeRoot>(AstList<ExprPtr>(&arena));
+    int result;
+    {
+        TimeScope parse_timer("parse");
+        result = yyparse();
+    }
     if (result != 0) return result;
-    fmt::print("\nParse finish!\n");
-    print_expr(root, "","",1);
+    mem_report().snapshot("parse");
+    LOG_INFO(LC_Driver, "\nParse finish!\n");
+    if (log_enabled(LC_AST, LL_Debug))
+        print_expr(root, "","",1);
     result = semantic_analysis(root);
     if (result != 0) return result;
-    cout << "passing semantic analysis" << endl;
-    ir_translate(root, argv[2]);
-    // ir_translate(root, argv[2], true);  // debug version
+    mem_report().snapshot("semantic analysis");
+    LOG_INFO(LC_Driver, "passing semantic analysis\n");
+    result = ir_translate(root, argv[2], false, ir_threads);
+    // ir_translate(root, argv[2], true, ir_threads);  // debug version
     return result;
 }
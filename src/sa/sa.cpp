@@ -1,98 +1,51 @@
 #include "sa/sa.h"
+#include "ast/visitor.h"
 #include <cassert>
-#include <fmt/core.h>
-#include <iostream>
+#include "common/log.h"
+#include "common/timer.h"
 
 
 int semantic_analysis(TreeRoot *root) {
-    Table<varType> varTable;
-    Table<FuncType> funcTable;
-    cout << "start semantic analysis" << endl;
-    return sa(root, varTable, funcTable, true);
+    TimeScope timer("semantic analysis");
+    SymbolTable varTable;
+    SymbolTable funcTable;
+    LOG_INFO(LC_Sema, "start semantic analysis\n");
+    root->symbols.clear();
+    return sa(root, varTable, funcTable, root->symbols, true);
 }
 
-int sa(ExprPtr node, Table<varType>& varTable, Table<FuncType>& funcTable, bool innerBlock) {
+namespace {
 
-    assert(node != nullptr);
+// statement level checks, returns 0 on success and -1 on error.
+// the bool argument tells whether a block opens its own env.
+class SemanticAnalyzer : public AstVisitor<SemanticAnalyzer, int, bool> {
+public:
+    SemanticAnalyzer(SymbolTable& varTable, SymbolTable& funcTable, std::vector<Symbol>& symbols)
+        : varTable(varTable), funcTable(funcTable), symbols(symbols) {}
 
     // root node
-    if (auto *root = node->as<TreeRoot *>()) {
+    int visit_root(TreeRoot *root, bool) {
 
-        cout << "------------------------" << endl;
-        fmt::print("analysis root\n");
+        LOG_DEBUG(LC_Sema, "------------------------\n");
+        LOG_DEBUG(LC_Sema, "analysis root\n");
         varTable.new_env();
         funcTable.new_env();
-        funcTable.add_one_entry("getint", FuncType({}, INT));
-        funcTable.add_one_entry("getch", FuncType({}, INT));
-        funcTable.add_one_entry("getarray", FuncType({varType(INT, 1)}, INT));
-        funcTable.add_one_entry("putint", FuncType({varType(INT, 0)}, VOID));
-        funcTable.add_one_entry("putch", FuncType({varType(INT, 0)}, VOID));
-        funcTable.add_one_entry("putarray", FuncType({varType(INT, 0), varType(INT, 1)}, VOID));
-        funcTable.add_one_entry("starttime", FuncType({}, VOID));
-        funcTable.add_one_entry("stoptime", FuncType({}, VOID));
+        declare_runtime("getint", FuncType({}, INT));
+        declare_runtime("getch", FuncType({}, INT));
+        declare_runtime("getarray", FuncType({varType(INT, 1)}, INT));
+        declare_runtime("putint", FuncType({varType(INT, 0)}, VOID));
+        declare_runtime("putch", FuncType({varType(INT, 0)}, VOID));
+        declare_runtime("putarray", FuncType({varType(INT, 0), varType(INT, 1)}, VOID));
+        declare_runtime("starttime", FuncType({}, VOID));
+        declare_runtime("stoptime", FuncType({}, VOID));
 
 
         // the code at least has one Decl or FuncDef
-        cout << "root items number: " << root->rootItems.size() << endl;
-        for (int i = root->rootItems.size() - 1; i >= 0; i--) { // attention to the order
-            
-            // varDecl, may have several var. eg. int a = 1, b, c = 1;
-            if (auto *varDeclNode = root->rootItems[i]->as<TreeVarDecl *>()) {  
-                cout << "------------------------" << endl;
-                fmt::print("analysis varDel\n");
-                for (int i = 0; i < varDeclNode->assignStmtNodes.size(); i++) {
-                    
-                    auto *assignStmtNode = varDeclNode->assignStmtNodes[i]->as<TreeAssignStmt *>();
-                    auto *varExpNode = assignStmtNode->lhs->as<TreeVarExpr *>();
-                    // add new var to now table.
-                    cout << "add " << varExpNode->name << " to table" << endl;
-                    std::vector<int> dimension_size;
-                    for (int i = 0; i < varExpNode->index.size(); i++) {
-                        auto *numberNode = varExpNode->index[i]->as<TreeNumber *>();
-                        dimension_size.push_back(numberNode->value);
-                    }
-                    if (varTable.add_one_entry(varExpNode->name, varType(varDeclNode->type, 0, dimension_size)) != 0) {
-                        cout << "cannot redeclare var" << endl;
-                        return -1;
-                    }
-
-                    // if the varDecl has assign expression, do type_check. eg. int a = 1;
-                    if (type_check(assignStmtNode, varTable, funcTable).type != 0)
-                        return -1;
-                }
-
-                continue;
-                
-            }
-
-            // funcDef
-            if (auto *funcDefNode = root->rootItems[i]->as<TreeFuncDef *>()) {
-
-                varTable.new_env();
-
-                cout << "------------------------" << endl;
-                fmt::print("analysis funcDef\n");
-                // add new func to now table
-                for (int i = 0; i < funcDefNode->type.inputType.size(); i++) {
-                    fmt::print("param dimension: {}\n", funcDefNode->type.inputType[i].dimension);
-                }
-                if (funcTable.add_one_entry(funcDefNode->funcName, funcDefNode->type) != 0) {
-                    cout << "cannot redefine func" << endl;
-                    return -1;
-                }
-
-                for (auto inputParam : funcDefNode->input_params)
-                    varTable.add_one_entry(inputParam.first, inputParam.second);
-
-                funcTable.set_func_name(funcDefNode->funcName);
-                // analysis block
-                if (sa(funcDefNode->blockNode, varTable, funcTable, false) != 0)
-                    return -1;
-                
-                varTable.quit_env();
-
-                continue;
-            }
+        LOG_TRACE(LC_Sema, "root items number: {}\n", root->rootItems.size());
+        for (auto *item : root->rootItems) { // items are kept in source order
+            // varDecl or funcDef
+            if (visit(item, true) != 0)
+                return -1;
         }
 
         // end sa
@@ -101,50 +54,81 @@ int sa(ExprPtr node, Table<varType>& varTable, Table<FuncType>& funcTable, bool
         return 0;
     }
 
+    // varDecl, may have several var. eg. int a = 1, b, c = 1;
+    int visit_var_decl(TreeVarDecl *varDeclNode, bool) {
+
+        LOG_DEBUG(LC_Sema, "------------------------\n");
+        LOG_DEBUG(LC_Sema, "analysis varDel\n");
+        for (int i = 0; i < varDeclNode->assignStmtNodes.size(); i++) {
+
+            auto *assignStmtNode = varDeclNode->assignStmtNodes[i]->as_unchecked<TreeAssignStmt *>();
+            auto *varExpNode = assignStmtNode->lhs->as_unchecked<TreeVarExpr *>();
+            // add new var to now table.
+            LOG_TRACE(LC_Sema, "add {} to table\n", varExpNode->name);
+            std::vector<int> dimension_size;
+            for (int i = 0; i < varExpNode->index.size(); i++) {
+                auto *numberNode = varExpNode->index[i]->as_unchecked<TreeNumber *>();
+                dimension_size.push_back(numberNode->value);
+            }
+            if (declare_var(varExpNode->name, varType(varDeclNode->type, 0, dimension_size)) == no_symbol) {
+                LOG_ERROR(LC_Sema, "cannot redeclare var\n");
+                return -1;
+            }
+
+            // if the varDecl has assign expression, do type_check. eg. int a = 1;
+            // this also resolves the declared var itself
+            if (type_check(assignStmtNode, varTable, funcTable, symbols)->type == FAIL)
+                return -1;
+        }
+        return 0;
+    }
+
+    // funcDef
+    int visit_func_def(TreeFuncDef *funcDefNode, bool) {
+        TimeScope timer("sema function", funcDefNode->funcName);
+
+        varTable.new_env();
+
+        LOG_DEBUG(LC_Sema, "------------------------\n");
+        LOG_DEBUG(LC_Sema, "analysis funcDef\n");
+        // add new func to now table
+        for (int i = 0; i < funcDefNode->type->inputType.size(); i++) {
+            LOG_TRACE(LC_Sema, "param dimension: {}\n", funcDefNode->type->inputType[i]->dimension);
+        }
+        funcDefNode->symbol = symbols.size();
+        symbols.push_back({funcDefNode->funcName, varType(), funcDefNode->type});
+        if (funcTable.add_one_entry(funcDefNode->funcName, funcDefNode->symbol) != 0) {
+            LOG_ERROR(LC_Sema, "cannot redefine func\n");
+            return -1;
+        }
+
+        // a repeated parameter name is not reported, it only stays hidden
+        funcDefNode->first_param = symbols.size();
+        for (auto &inputParam : funcDefNode->input_params)
+            declare_var(inputParam.first, inputParam.second);
+
+        funcTable.set_func_name(funcDefNode->funcName);
+        // analysis block
+        if (visit(funcDefNode->blockNode, false) != 0)
+            return -1;
+
+        varTable.quit_env();
+        return 0;
+    }
+
     // block node
-    if (auto *blockNode = node->as<TreeBlock *>()) {
+    int visit_block(TreeBlock *blockNode, bool innerBlock) {
 
-        cout << "------------------------" << endl;
-        fmt::print("analysis block\n");
+        LOG_DEBUG(LC_Sema, "------------------------\n");
+        LOG_DEBUG(LC_Sema, "analysis block\n");
         // enter new env
         if (innerBlock)
             varTable.new_env();
 
-        cout << "block items number: " << blockNode->blockItems.size() << endl;
+        LOG_TRACE(LC_Sema, "block items number: {}\n", blockNode->blockItems.size());
         // may have no Decl or Stmt
-        for (int i = 0; i < blockNode->blockItems.size(); i++) {
-            
-            // varDecl eg. int a = 1;
-            if (auto *varDeclNode = blockNode->blockItems[i]->as<TreeVarDecl *>()) {
-
-                cout << "------------------------" << endl;
-                fmt::print("analysis varDel\n");
-                for (int i = 0; i < varDeclNode->assignStmtNodes.size(); i++) {
-                    // 
-                    auto *assignStmtNode = varDeclNode->assignStmtNodes[i]->as<TreeAssignStmt *>();
-                    auto *varExpNode = assignStmtNode->lhs->as<TreeVarExpr *>();
-                    // add new var to now table.
-                    cout << "add " << varExpNode->name << " to table" << endl; 
-                    std::vector<int> dimension_size;
-                    for (int i = 0; i < varExpNode->index.size(); i++) {
-                        auto *numberNode = varExpNode->index[i]->as<TreeNumber *>();
-                        dimension_size.push_back(numberNode->value);
-                    }
-                    if (varTable.add_one_entry(varExpNode->name, varType(varDeclNode->type, 0, dimension_size)) != 0) {
-                        cout << "cannot redeclare var" << endl;
-                        return -1;
-                    }
-
-                    // if the varDecl has assign expression, do type_check. eg. int a = 1;
-                    if (type_check(assignStmtNode, varTable, funcTable).type == FAIL) 
-                        return -1;
-                }
-
-                continue;
-            }
-
-            // stmt
-            if (sa(blockNode->blockItems[i], varTable, funcTable, true) != 0)
+        for (auto *item : blockNode->blockItems) {
+            if (visit(item, true) != 0)
                 return -1;
         }
 
@@ -154,101 +138,58 @@ int sa(ExprPtr node, Table<varType>& varTable, Table<FuncType>& funcTable, bool
         return 0;
     }
 
-
     // stmt
     // assignStmt eg. a = b;
-    if (auto *assignStmtNode = node->as<TreeAssignStmt *>()) {
-
-        cout << "------------------------" << endl;
-        fmt::print("analysis assignStmt\n");
-        // do type_check
-        if (type_check(assignStmtNode, varTable, funcTable).type == FAIL)
-            return -1;
-        
-        return 0;
+    int visit_assign(TreeAssignStmt *assignStmtNode, bool) {
+        return check_expr(assignStmtNode, "assignStmt");
     }
 
     // ExpStmt
     // unaryExp eg. !a, !f(x)
-    if (auto *unaryExpNode = node->as<TreeUnaryExpr *>()) {
-
-        cout << "------------------------" << endl;
-        fmt::print("analysis unaryExp\n");
-        // do type_check
-        if (type_check(unaryExpNode, varTable, funcTable).type == FAIL)
-            return -1;
-
-        return 0;
+    int visit_unary(TreeUnaryExpr *unaryExpNode, bool) {
+        return check_expr(unaryExpNode, "unaryExp");
     }
 
     // binaryExp
-    if (auto *binaryExpNode = node->as<TreeBinaryExpr *>()) {
-
-        cout << "------------------------" << endl;
-        fmt::print("analysis binaryExp\n");
-        // do type_check
-        if (type_check(binaryExpNode, varTable, funcTable).type == FAIL)
-            return -1;
-
-        return 0;
+    int visit_binary(TreeBinaryExpr *binaryExpNode, bool) {
+        return check_expr(binaryExpNode, "binaryExp");
     }
 
     // funcExp eg. f(x)
-    if (auto *funcExpNode = node->as<TreeFuncExpr *>()) {
-
-        cout << "------------------------" << endl;
-        fmt::print("analysis funcExp\n");
-        // do type_check
-        if (type_check(funcExpNode, varTable, funcTable).type == FAIL)
-            return -1;
-
-        return 0;
+    int visit_call(TreeFuncExpr *funcExpNode, bool) {
+        return check_expr(funcExpNode, "funcExp");
     }
 
     // varExp eg. a, a[1]
-    if (auto *varExpNode = node->as<TreeVarExpr *>()) {
-
-        cout << "------------------------" << endl;
-        fmt::print("analysis varExp\n");
-        // do type_check
-        if (type_check(varExpNode, varTable, funcTable).type == FAIL)
-            return -1;
-
-        return 0;
+    int visit_var(TreeVarExpr *varExpNode, bool) {
+        return check_expr(varExpNode, "varExp");
     }
 
     // number
-    if (auto *numberNode = node->as<TreeNumber *>()) {
-
-        cout << "------------------------" << endl;
-        fmt::print("analysis number\n");
-        // do type_check
-        if (type_check(numberNode, varTable, funcTable).type == FAIL)
-            return -1;
-
-        return 0;
+    int visit_number(TreeNumber *numberNode, bool) {
+        return check_expr(numberNode, "number");
     }
 
     // ifStmt
-    if (auto *ifStmtNode = node->as<TreeIfStmt *>()) {
+    int visit_if(TreeIfStmt *ifStmtNode, bool) {
 
-        cout << "------------------------" << endl;
-        fmt::print("analysis ifStmt\n");
+        LOG_DEBUG(LC_Sema, "------------------------\n");
+        LOG_DEBUG(LC_Sema, "analysis ifStmt\n");
         // check if condition
-        varType condition_type = type_check(ifStmtNode->conditionExp, varTable, funcTable);
-        if (condition_type.type != INT || condition_type.dimension != 0)
+        varType condition_type = type_check(ifStmtNode->conditionExp, varTable, funcTable, symbols);
+        if (condition_type->type != INT || condition_type->dimension != 0)
             return -1;
 
         // analysis true stmt
-        if (sa(ifStmtNode->trueStmtNode, varTable, funcTable, true) != 0) {
+        if (visit(ifStmtNode->trueStmtNode, true) != 0) {
             return -1;
         }
 
         // if has else
         if (ifStmtNode->elseStmtNode != nullptr) {
-            
+
             // analysis else stmt
-            if (sa(ifStmtNode->elseStmtNode, varTable, funcTable, true) != 0)
+            if (visit(ifStmtNode->elseStmtNode, true) != 0)
                 return -1;
         }
 
@@ -256,17 +197,17 @@ int sa(ExprPtr node, Table<varType>& varTable, Table<FuncType>& funcTable, bool
     }
 
     // while stmt
-    if (auto *whileStmtNode = node->as<TreeWhileStmt *>()) {
+    int visit_while(TreeWhileStmt *whileStmtNode, bool) {
 
-        cout << "------------------------" << endl;
-        fmt::print("analysis whileStmt\n");
+        LOG_DEBUG(LC_Sema, "------------------------\n");
+        LOG_DEBUG(LC_Sema, "analysis whileStmt\n");
         // check while condition
-        varType condition_type = type_check(whileStmtNode->conditionExp, varTable, funcTable);
-        if (condition_type.type != INT || condition_type.dimension != 0)
+        varType condition_type = type_check(whileStmtNode->conditionExp, varTable, funcTable, symbols);
+        if (condition_type->type != INT || condition_type->dimension != 0)
             return -1;
 
         // analysis true stmt
-        if (sa(whileStmtNode->trueStmtNode, varTable, funcTable, true) != 0)
+        if (visit(whileStmtNode->trueStmtNode, true) != 0)
             return -1;
 
         return 0;
@@ -277,30 +218,49 @@ int sa(ExprPtr node, Table<varType>& varTable, Table<FuncType>& funcTable, bool
     // continue stmt, no need to check
 
     // return stmt
-    if (auto *returnStmtNode = node->as<TreeReturnStmt *>()) {
+    int visit_return(TreeReturnStmt *returnStmtNode, bool) {
+        return check_expr(returnStmtNode, "returnStmt");
+    }
 
-        cout << "------------------------" << endl;
-        fmt::print("analysis returnStmt\n");
-        // check return type and the function type
-        if (type_check(returnStmtNode, varTable, funcTable).type == FAIL)
+private:
+    int check_expr(ExprPtr node, const char *what) {
+        LOG_DEBUG(LC_Sema, "------------------------\n");
+        LOG_DEBUG(LC_Sema, "analysis {}\n", what);
+        // do type_check
+        if (type_check(node, varTable, funcTable, symbols)->type == FAIL)
             return -1;
-
         return 0;
     }
 
-    return 0;
+    // new symbol for a var in the current env, no_symbol if it is already there
+    uint32_t declare_var(std::string_view name, varType type) {
+        uint32_t id = symbols.size();
+        symbols.push_back({name, type, FuncType()});
+        if (varTable.add_one_entry(name, id) != 0)
+            return no_symbol;
+        return id;
+    }
+
+    void declare_runtime(std::string_view name, FuncType type) {
+        funcTable.add_one_entry(name, symbols.size());
+        symbols.push_back({name, varType(), type, true});
+    }
+
+    SymbolTable& varTable;
+    SymbolTable& funcTable;
+    std::vector<Symbol>& symbols;
+};
+
+} // namespace
+
+int sa(ExprPtr node, SymbolTable& varTable, SymbolTable& funcTable, std::vector<Symbol>& symbols, bool innerBlock) {
+    assert(node != nullptr);
+    return SemanticAnalyzer(varTable, funcTable, symbols).visit(node, innerBlock);
 }
 
+// array arguments match when everything but the first dimension agrees
 bool equal_for_func_call(varType input_type, varType func_param_type) {
-    if (input_type.type != func_param_type.type || input_type.dimension != func_param_type.dimension)
-        return false;
-    if (input_type.dimension <= 1)
-        return true;
-    for (int i = 1; i < input_type.dimension; i++) {
-        if (input_type.dimension_size[i] != func_param_type.dimension_size[i])
-            return false;
-    }
-    return true;
+    return input_type.decayed() == func_param_type.decayed();
 }
 
 
@@ -308,163 +268,186 @@ bool equal_for_func_call(varType input_type, varType func_param_type) {
     var/func into type_check, while searching for the type.
 */
 
-varType type_check(TreeExpr * node, Table<varType> varTable, Table<FuncType> funcTable) {
+
+namespace {
+
+// computes the type of an expression, FAIL if it doesn't type check
+class TypeChecker : public AstVisitor<TypeChecker, varType> {
+public:
+    TypeChecker(SymbolTable& varTable, SymbolTable& funcTable, std::vector<Symbol>& symbols)
+        : varTable(varTable), funcTable(funcTable), symbols(symbols) {}
+
+    // type of node, computed once and then kept on the node
+    varType check(ExprPtr node) {
+        if (!node->checked_type)
+            node->checked_type = visit(node);
+        return node->checked_type;
+    }
+
+    varType visit_default(ExprPtr) {
+        return varType(FAIL, 0);
+    }
 
     // assign stmt
     /* check if the type on the left is the same as the right. */
-    if (auto *assignStmtNode = node->as<TreeAssignStmt *>()) {
-        cout << "check assignStmt " << endl;
-        varType left = type_check(assignStmtNode->lhs, varTable, funcTable);
+    varType visit_assign(TreeAssignStmt *assignStmtNode) {
+        LOG_TRACE(LC_Sema, "check assignStmt \n");
+        varType left = check(assignStmtNode->lhs);
         if (assignStmtNode->rhs == nullptr) {
-            cout << "pass(in varDecl)" << endl;
+            LOG_TRACE(LC_Sema, "pass(in varDecl)\n");
             return left;
         }
-        varType right = type_check(assignStmtNode->rhs, varTable, funcTable);
-        if (left.type == FAIL || right.type == FAIL) {
-            cout << "fail: right ot left not pass" << endl;
+        varType right = check(assignStmtNode->rhs);
+        if (left->type == FAIL || right->type == FAIL) {
+            LOG_DEBUG(LC_Sema, "fail: right ot left not pass\n");
             return varType(FAIL, 0);
         }
-        if (left.type != INT || left.dimension != 0 || right.type != INT || right.dimension != 0) {
-            cout << "fail: assign type must be INT" << endl;
+        if (left->type != INT || left->dimension != 0 || right->type != INT || right->dimension != 0) {
+            LOG_ERROR(LC_Sema, "fail: assign type must be INT\n");
             return varType(FAIL, 0);
         } else {
-            cout << "pass" << endl;
+            LOG_TRACE(LC_Sema, "pass\n");
             return left;
         }
-
     }
 
     // return stmt
     /* check if the return type is the same as the declared one. */
-    if (auto *returnStmtNode = node->as<TreeReturnStmt *>()) {
-        cout << "check returnStmt " << endl;
-        // TODO: complete your code here
+    varType visit_return(TreeReturnStmt *returnStmtNode) {
+        LOG_TRACE(LC_Sema, "check returnStmt \n");
         varType res;
         if (returnStmtNode->returnExp == nullptr) {
-            res.type = VOID;
+            res = varType(VOID, 0);
         } else {
-            res=type_check(returnStmtNode->returnExp,varTable,funcTable);
+            res = check(returnStmtNode->returnExp);
         }
-        if (res.type==FAIL) {
-            cout << "fail: returnExp not pass" << endl;
+        if (res->type==FAIL) {
+            LOG_DEBUG(LC_Sema, "fail: returnExp not pass\n");
             return varType(FAIL, 0);
         }
-        FuncType *typPtr = funcTable.lookup(funcTable.get_cur_func_name());
-        if (typPtr == nullptr) {
-            cout << "fail: current function not found" << endl;
+        uint32_t *funcId = funcTable.lookup(funcTable.get_cur_func_name());
+        if (funcId == nullptr) {
+            LOG_ERROR(LC_Sema, "fail: current function not found\n");
             return varType(FAIL, 0);
         }
-        FuncType typ = *typPtr;
-        if ((res.type == VOID && typ.returnType == VOID) || 
-            (res.type == INT && res.dimension == 0 && typ.returnType == INT)) {
-            cout << "pass" << endl;
+        FuncType typ = symbols[*funcId].func_type;
+        if ((res->type == VOID && typ->returnType == VOID) ||
+            (res->type == INT && res->dimension == 0 && typ->returnType == INT)) {
+            LOG_TRACE(LC_Sema, "pass\n");
             return res;
         }
-        cout << "fail: type dosen't match" << endl;
+        LOG_ERROR(LC_Sema, "fail: type dosen't match\n");
         return varType(FAIL,0);
     }
 
     // unary exp
     /* return the result type */
-    if (auto *unaryExpNode = node->as<TreeUnaryExpr *>()) {
-        cout << "check unaryExp " << endl;
-        varType expType = type_check(unaryExpNode->operand, varTable, funcTable);
-        if (expType.type != INT && expType.dimension != 0) {
-            cout << "fail: unary exp type must be INT" << endl;
+    varType visit_unary(TreeUnaryExpr *unaryExpNode) {
+        LOG_TRACE(LC_Sema, "check unaryExp \n");
+        varType expType = check(unaryExpNode->operand);
+        if (expType->type != INT && expType->dimension != 0) {
+            LOG_ERROR(LC_Sema, "fail: unary exp type must be INT\n");
             return varType(FAIL, 0);
         }
-        return type_check(unaryExpNode->operand, varTable, funcTable);
+        return expType;
     }
 
     // binary exp
     /* check the type of two operands. */
-    if (auto *binaryExpNode = node->as<TreeBinaryExpr *>()) {
-        cout << "check binaryExp" << endl;
-        // TODO: complete your code here
-        varType left=type_check(binaryExpNode->lhs,varTable,funcTable);
-        varType right=type_check(binaryExpNode->rhs,varTable,funcTable);
-        if (left.type==FAIL||right.type==FAIL) {
-            cout << "fail: right ot left not pass" << endl;
+    varType visit_binary(TreeBinaryExpr *binaryExpNode) {
+        LOG_TRACE(LC_Sema, "check binaryExp\n");
+        varType left = check(binaryExpNode->lhs);
+        varType right = check(binaryExpNode->rhs);
+        if (left->type==FAIL||right->type==FAIL) {
+            LOG_DEBUG(LC_Sema, "fail: right ot left not pass\n");
             return varType(FAIL,0);
         }
-        if (left.type != INT || left.dimension != 0 || right.type != INT || right.dimension != 0) {
-            cout << "fail: binary type must be INT" << endl;
+        if (left->type != INT || left->dimension != 0 || right->type != INT || right->dimension != 0) {
+            LOG_ERROR(LC_Sema, "fail: binary type must be INT\n");
             return varType(FAIL, 0);
         } else {
-            cout << "pass" << endl;
+            LOG_TRACE(LC_Sema, "pass\n");
             return left;
         }
     }
 
     // func exp
     /* check the type of the input params and the declared ones. */
-    if (auto *funcExpNode = node->as<TreeFuncExpr *>()) {
-        // TODO: complete your code here
-        cout << "check funcExp " << endl;
-        std::vector<ExprPtr> name_vec=funcExpNode->varNames;
-        string name = funcExpNode->name;
-        FuncType *funcPtr = funcTable.lookup(name);
-        if (funcPtr == nullptr) {
-            cout << "fail: no function named \"" << name << "\"" << endl;
+    varType visit_call(TreeFuncExpr *funcExpNode) {
+        LOG_TRACE(LC_Sema, "check funcExp \n");
+        const AstList<ExprPtr>& name_vec=funcExpNode->varNames;
+        std::string_view name = funcExpNode->name;
+        uint32_t *funcId = funcTable.lookup(name);
+        if (funcId == nullptr) {
+            LOG_ERROR(LC_Sema, "fail: no function named \"{}\"\n", name);
             return varType(FAIL, 0);
         }
-        FuncType func = *funcPtr;
-        std::vector<varType> input_param=func.inputType;
-        int cur=0;
+        funcExpNode->symbol = *funcId;
+        FuncType func = symbols[*funcId].func_type;
+        const std::vector<varType>& input_param=func->inputType;
         if (input_param.size() != name_vec.size()) {
-            cout << "fail: params number doesn't match" << endl;
+            LOG_ERROR(LC_Sema, "fail: params number doesn't match\n");
             return varType(FAIL, 0);
         }
         for (int i = 0; i < name_vec.size(); i++) {
-            varType inputType = type_check(name_vec[i], varTable, funcTable);
-            if (inputType.type == FAIL) {
-                cout << "fail: input varExp not pass" << endl;
+            varType inputType = check(name_vec[i]);
+            if (inputType->type == FAIL) {
+                LOG_DEBUG(LC_Sema, "fail: input varExp not pass\n");
                 return varType(FAIL, 0);
             }
 
             if (!equal_for_func_call(inputType, input_param[i])) {
-                cout << "fail: input param doesn't match" << endl;
+                LOG_ERROR(LC_Sema, "fail: input param doesn't match\n");
                 return varType(FAIL, 0);
             }
         }
-        cout << "pass" << endl;
-        return varType(func.returnType, 0);
+        LOG_TRACE(LC_Sema, "pass\n");
+        return varType(func->returnType, 0);
     }
 
     // var exp
     /* check the use of the var and the declared one. */
-    if (auto *varExpNode = node->as<TreeVarExpr *>()) {
-        cout << "check varExp " << endl;
-        // TODO: complete your code here
+    varType visit_var(TreeVarExpr *varExpNode) {
+        LOG_TRACE(LC_Sema, "check varExp \n");
         for (int i = 0; i < varExpNode->index.size(); i++) {
-            varType index_type = type_check(varExpNode->index[i], varTable, funcTable);
-            if (index_type.type != INT || index_type.dimension != 0) {
-                cout << "fail: index must be INT" << endl;
+            varType index_type = check(varExpNode->index[i]);
+            if (index_type->type != INT || index_type->dimension != 0) {
+                LOG_ERROR(LC_Sema, "fail: index must be INT\n");
                 return varType(FAIL, 0);
             }
         }
-        varType *typePtr = varTable.lookup(varExpNode->name);
-        if (typePtr == nullptr) {
-            cout << "fail: var named \"" << varExpNode->name << "\" not found" << endl;
+        uint32_t *varId = varTable.lookup(varExpNode->name);
+        if (varId == nullptr) {
+            LOG_ERROR(LC_Sema, "fail: var named \"{}\" not found\n", varExpNode->name);
             return varType(FAIL, 0);
         }
-        varType type = *typePtr;
-        if (type.dimension < varExpNode->index.size()) {
-            cout << "fail: var doesn't have such dimension" << endl;
+        varExpNode->symbol = *varId;
+        varType type = symbols[*varId].var_type;
+        if (type->dimension < varExpNode->index.size()) {
+            LOG_ERROR(LC_Sema, "fail: var doesn't have such dimension\n");
             return varType(FAIL, 0);
         }
-        cout << "pass" << endl;
+        LOG_TRACE(LC_Sema, "pass\n");
         std::vector<int> dimension_size;
-        for (int i = varExpNode->index.size(); i < type.dimension; i++)
-            dimension_size.push_back(type.dimension_size[i]);
-        return varType(type.type, 0, dimension_size);
+        for (int i = varExpNode->index.size(); i < type->dimension; i++)
+            dimension_size.push_back(type->dimension_size[i]);
+        return varType(type->type, 0, dimension_size);
     }
 
     // number
     /* just return INT */
-    if (auto *numberNode = node->as<TreeNumber *>()) {
-
+    varType visit_number(TreeNumber *) {
         return varType(INT, 0);
     }
 
-}
\ No newline at end of file
+private:
+    SymbolTable& varTable;
+    SymbolTable& funcTable;
+    std::vector<Symbol>& symbols;
+};
+
+} // namespace
+
+varType type_check(TreeExpr * node, SymbolTable& varTable, SymbolTable& funcTable, std::vector<Symbol>& symbols) {
+    return TypeChecker(varTable, funcTable, symbols).check(node);
+}
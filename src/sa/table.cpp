@@ -0,0 +1,59 @@
+#include "sa/table.h"
+
+NameInterner &symbol_names() {
+    static NameInterner names;
+    return names;
+}
+
+// FNV-1a
+uint32_t NameInterner::hash_name(std::string_view name) {
+    uint32_t h = 2166136261u;
+    for (unsigned char c : name) {
+        h ^= c;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// slot holding name, or the empty slot where it would go
+std::size_t NameInterner::probe(std::string_view name, uint32_t hash) const {
+    std::size_t mask = slots.size() - 1;
+    for (std::size_t i = hash & mask;; i = (i + 1) & mask) {
+        const Slot &slot = slots[i];
+        if (slot.id == npos || (slot.hash == hash && names[slot.id] == name))
+            return i;
+    }
+}
+
+uint32_t NameInterner::find(std::string_view name) const {
+    if (slots.empty())
+        return npos;
+    return slots[probe(name, hash_name(name))].id;
+}
+
+uint32_t NameInterner::intern(std::string_view name) {
+    if ((names.size() + 1) * 2 > slots.size())
+        grow();
+    uint32_t hash = hash_name(name);
+    Slot &slot = slots[probe(name, hash)];
+    if (slot.id == npos) {
+        slot.hash = hash;
+        slot.id = names.size();
+        names.emplace_back(name);
+    }
+    return slot.id;
+}
+
+void NameInterner::grow() {
+    auto old = std::move(slots);
+    slots.assign(old.empty() ? 64 : old.size() * 2, Slot{});
+    std::size_t mask = slots.size() - 1;
+    for (const Slot &slot : old) {
+        if (slot.id == npos)
+            continue;
+        std::size_t i = slot.hash & mask;
+        while (slots[i].id != npos)
+            i = (i + 1) & mask;
+        slots[i] = slot;
+    }
+}
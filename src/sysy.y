@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <string>
 #include <ast/ast.h>
+#include <common/log.h>
 #include <stdlib.h>
 #include <stdarg.h>
 #include <iostream>
@@ -15,18 +16,18 @@ extern TreeRoot* root;
 /// types
 %union {
     int ival;
-    std::string *strPtr;
+    const char *ident;
     ExprPtr expr;
     OpType op;
-    std::vector<ExprPtr> *vec1Ptr;
-    std::vector< std::pair< std::string, varType> > *vec2Ptr;
-    std::pair<std::string, varType> *pairPtr;
-    std::vector<int> *dimension_size_ptr;
+    AstList<ExprPtr> *vec1Ptr;
+    std::vector< std::pair< std::string_view, varType> > *vec2Ptr;
+    std::pair<std::string_view, varType> *pairPtr;
+    AstList<int> *dimension_size_ptr;
     TreeRoot* rt;
 }
 
 %token <ival> Int
-%token <strPtr> Ident
+%token <ident> Ident
 %token TyInt TyVoid If Else For While Return Break Continue 
 %token LParen RParen LBrace RBrace LBracket RBracket Semicolon Comma SQuote DQuote
 %token Assign Eq Neq Lt Gt Lte Gte Plus Minus Mul Div Mod And Or Not Dot
@@ -39,10 +40,10 @@ extern TreeRoot* root;
             ReturnExp Exp LVal PrimaryExp UnaryExp  
             MulExp AddExp RelExp EqExp LAndExp LOrExp
 %type <op> UnaryOp 
-%type <vec1Ptr> FuncRParams MoreFuncRParams ValIndex BlockItems Dimension MoreVarDef
-%type <vec2Ptr> MoreFuncFParams FuncFParams
+%type <vec1Ptr> FuncRParams FuncRParamList ValIndex BlockItems Dimension VarDefList
+%type <vec2Ptr> FuncFParamList FuncFParams
 %type <pairPtr> FuncFParam
-%type <dimension_size_ptr> DimParams MoreDimParams
+%type <dimension_size_ptr> DimParams
 %type <rt> CompUnit
 
 /// priority
@@ -67,45 +68,44 @@ CompUnit : CompUnit VarDecl {
                                 root->append($2);
                             }
         | VarDecl {
-                                root = new TreeRoot(std::vector<ExprPtr>{});
+                                root = ast_arena->make<TreeRoot>(AstList<ExprPtr>(ast_arena));
                                 root->append($1);
         }
         | FuncDef {
-                                root = new TreeRoot(std::vector<ExprPtr>{});
+                                root = ast_arena->make<TreeRoot>(AstList<ExprPtr>(ast_arena));
                                 root->append($1);
         }
         ;
 
-VarDecl : TyInt VarDef MoreVarDef Semicolon {
-                                $3->insert($3->begin(), $2);
-                                $$ = new TreeVarDecl(INT, *$3);
+VarDecl : TyInt VarDefList Semicolon {
+                                $$ = ast_arena->make<TreeVarDecl>(INT, *$2);
         };
-MoreVarDef : Comma VarDef MoreVarDef {
-                                $3->insert($3->begin(), $2);
-                                $$ = $3;
+VarDefList : VarDefList Comma VarDef {
+                                $1->push_back($3);
+                                $$ = $1;
 }
-        | {
-                                $$ = new std::vector<ExprPtr>{};
+        | VarDef {
+                                $$ = ast_arena->make<AstList<ExprPtr>>(ast_arena, std::initializer_list<ExprPtr>{$1});
         }
         ;
 
 VarDef : Ident Assign InitVal {
-                                ExprPtr left = new TreeVarExpr(*$1, std::vector<ExprPtr>{});
-                                $$ = new TreeAssignStmt(left, $3);
+                                ExprPtr left = ast_arena->make<TreeVarExpr>($1, AstList<ExprPtr>(ast_arena));
+                                $$ = ast_arena->make<TreeAssignStmt>(left, $3);
 }
         | Ident Dimension {
-                                ExprPtr left = new TreeVarExpr(*$1,*$2);
-                                $$ = new TreeAssignStmt(left, NULL);                       
+                                ExprPtr left = ast_arena->make<TreeVarExpr>($1, *$2);
+                                $$ = ast_arena->make<TreeAssignStmt>(left, nullptr);                       
         }
         ;
         
-Dimension : LBracket Int RBracket Dimension {
-                                ExprPtr t = new TreeNumber($2);
-                                $4->insert($4->begin(), t); // reverse indexes
-                                $$ = $4;
+Dimension : Dimension LBracket Int RBracket {
+                                ExprPtr t = ast_arena->make<TreeNumber>($3);
+                                $1->push_back(t);
+                                $$ = $1;
 }
         | {
-                                $$ = new std::vector<ExprPtr>{};
+                                $$ = ast_arena->make<AstList<ExprPtr>>(ast_arena);
         }
         ;
 
@@ -114,64 +114,60 @@ InitVal : Exp {
 };
 
 FuncDef : TyInt Ident LParen FuncFParams RParen Block {
-                                $$ = new TreeFuncDef(*$2, *$4, INT, $6);
+                                $$ = ast_arena->make<TreeFuncDef>($2, std::move(*$4), INT, $6);
 }
         | TyVoid Ident LParen FuncFParams RParen Block {
-                                $$ = new TreeFuncDef(*$2, *$4, VOID, $6);
+                                $$ = ast_arena->make<TreeFuncDef>($2, std::move(*$4), VOID, $6);
         }
         ;
 
-FuncFParams : FuncFParam MoreFuncFParams {
-                                $2->insert($2->begin(), *$1);
-                                $$ = $2;
+FuncFParams : FuncFParamList {
+                                $$ = $1;
 }
         | {
-                                $$ = new std::vector< std::pair< std::string, varType> > {};
+                                $$ = ast_arena->make<std::vector< std::pair< std::string_view, varType> >>();
         }
         ;
 
-FuncFParam : TyInt Ident DimParams {
-                                varType v = varType(INT, 0, *$3);
-                                $$ = new std::pair<std::string, varType>(*$2, v);
-};
-
-DimParams : LBracket RBracket MoreDimParams {
-                                $3->insert($3->begin(), 0);
-                                $$ = $3;
+FuncFParamList : FuncFParamList Comma FuncFParam {
+                                $1->push_back(std::move(*$3));
+                                $$ = $1;
 }
-        | {
-                                $$ = new std::vector<int>();
+        | FuncFParam {
+                                $$ = ast_arena->make<std::vector< std::pair< std::string_view, varType> >>();
+                                $$->push_back(std::move(*$1));
         }
         ;
 
-MoreDimParams : LBracket Int RBracket MoreDimParams {
-                                $4->insert($4->begin(), $2);
-                                $$ = $4;
+FuncFParam : TyInt Ident DimParams {
+                                varType v = varType(INT, 0, std::vector<int>($3->begin(), $3->end()));
+                                $$ = ast_arena->make<std::pair<std::string_view, varType>>($2, v);
 }
-        | {
-                                $$ = new std::vector<int>();
+        | TyInt Ident {
+                                $$ = ast_arena->make<std::pair<std::string_view, varType>>($2, varType(INT, 0));
         }
         ;
 
-MoreFuncFParams : Comma FuncFParam MoreFuncFParams {
-                                $3->insert($3->begin(), *$2);
-                                $$ = $3;
+// the first dimension of an array parameter is always omitted, eg. a[][3]
+DimParams : DimParams LBracket Int RBracket {
+                                $1->push_back($3);
+                                $$ = $1;
 }
-        | {
-                                $$ = new std::vector< std::pair< std::string, varType> > {};
+        | LBracket RBracket {
+                                $$ = ast_arena->make<AstList<int>>(ast_arena, std::initializer_list<int>{0});
         }
         ;
 
 Block : LBrace BlockItems RBrace {
-                                $$ = new TreeBlock(*$2);
+                                $$ = ast_arena->make<TreeBlock>(*$2);
 };
 
-BlockItems : BlockItem BlockItems {
-                                $2->insert($2->begin(), $1);
-                                $$ = $2;
+BlockItems : BlockItems BlockItem {
+                                $1->push_back($2);
+                                $$ = $1;
 }
         | {
-                                $$ = new std::vector<ExprPtr>{};
+                                $$ = ast_arena->make<AstList<ExprPtr>>(ast_arena);
         }
         ;
 
@@ -184,7 +180,7 @@ BlockItem : VarDecl {
         ;
 
 Stmt : LVal Assign Exp Semicolon {
-                                $$ = new TreeAssignStmt($1, $3);     
+                                $$ = ast_arena->make<TreeAssignStmt>($1, $3);     
 }
         | Exp Semicolon {
                                 $$ = $1;      
@@ -193,22 +189,22 @@ Stmt : LVal Assign Exp Semicolon {
                                 $$ = $1;
         }
         | If LParen Exp RParen Stmt Else Stmt {
-                                $$ = new TreeIfStmt($3, $5, $7);
+                                $$ = ast_arena->make<TreeIfStmt>($3, $5, $7);
         }
         | If LParen Exp RParen Stmt %prec LowerThanElse {
-                                $$ = new TreeIfStmt($3, $5, NULL);
+                                $$ = ast_arena->make<TreeIfStmt>($3, $5, nullptr);
         }
         | While LParen Exp RParen Stmt {
-                                $$ = new TreeWhileStmt($3, $5);
+                                $$ = ast_arena->make<TreeWhileStmt>($3, $5);
         }
         | Break Semicolon {
-                                $$ = new TreeWhileControlStmt("Break");
+                                $$ = ast_arena->make<TreeWhileControlStmt>("Break");
         }
         | Continue Semicolon {
-                                $$ = new TreeWhileControlStmt("Continue");
+                                $$ = ast_arena->make<TreeWhileControlStmt>("Continue");
         }
         | Return ReturnExp Semicolon {
-                                $$ = new TreeReturnStmt($2);
+                                $$ = ast_arena->make<TreeReturnStmt>($2);
         }
         ;
 
@@ -225,15 +221,15 @@ Exp : LOrExp{
 };
 
 LVal : Ident ValIndex {
-                                $$ = new TreeVarExpr(*$1, *$2);
+                                $$ = ast_arena->make<TreeVarExpr>($1, *$2);
 };
 
-ValIndex : LBracket Exp RBracket ValIndex {
-                                $4->insert($4->begin(), $2);
-                                $$ = $4;
+ValIndex : ValIndex LBracket Exp RBracket {
+                                $1->push_back($3);
+                                $$ = $1;
 }
         | {
-                                $$ = new std::vector<ExprPtr> {};
+                                $$ = ast_arena->make<AstList<ExprPtr>>(ast_arena);
         }
         ;
 
@@ -244,7 +240,7 @@ PrimaryExp : LParen Exp RParen {
                                 $$ = $1;
         }
         | Int {
-                                $$ = new TreeNumber($1);
+                                $$ = ast_arena->make<TreeNumber>($1);
         }
         ;
 
@@ -252,28 +248,27 @@ UnaryExp : PrimaryExp {
                                 $$ = $1;
 }
         | Ident LParen FuncRParams RParen {
-                                $$ = new TreeFuncExpr(*$1, *$3);
+                                $$ = ast_arena->make<TreeFuncExpr>($1, *$3);
         }
         | UnaryOp UnaryExp {
-                                $$ = new TreeUnaryExpr($1, $2);
+                                $$ = ast_arena->make<TreeUnaryExpr>($1, $2);
         }
         ;
 
-FuncRParams : Exp MoreFuncRParams{
-                                $2->insert($2->begin(), $1);
-                                $$ = $2;
+FuncRParams : FuncRParamList {
+                                $$ = $1;
 }
         | {
-                                $$ = new std::vector<ExprPtr>{} ;
+                                $$ = ast_arena->make<AstList<ExprPtr>>(ast_arena);
         }
         ;
 
-MoreFuncRParams : Comma Exp MoreFuncRParams {
-                                $3->insert($3->begin(), $2);
-                                $$ = $3;
+FuncRParamList : FuncRParamList Comma Exp {
+                                $1->push_back($3);
+                                $$ = $1;
 }
-        | {
-                                $$ = new std::vector<ExprPtr>{} ;
+        | Exp {
+                                $$ = ast_arena->make<AstList<ExprPtr>>(ast_arena, std::initializer_list<ExprPtr>{$1});
         }
         ;
 
@@ -293,13 +288,13 @@ MulExp : UnaryExp {
                                 $$ = $1;
 }
         | MulExp Mul UnaryExp{
-                                $$ = new TreeBinaryExpr(OP_Mul, $1, $3);
+                                $$ = ast_arena->make<TreeBinaryExpr>(OP_Mul, $1, $3);
         }
         | MulExp Div UnaryExp{
-                                $$ = new TreeBinaryExpr(OP_Div, $1, $3);
+                                $$ = ast_arena->make<TreeBinaryExpr>(OP_Div, $1, $3);
         }
         | MulExp Mod UnaryExp{
-                                $$ = new TreeBinaryExpr(OP_Mod, $1, $3);
+                                $$ = ast_arena->make<TreeBinaryExpr>(OP_Mod, $1, $3);
         }
         ;
 
@@ -307,10 +302,10 @@ AddExp : MulExp {
                                 $$ = $1;
 }
         | AddExp Plus MulExp {
-                                $$ = new TreeBinaryExpr(OP_Add, $1, $3);
+                                $$ = ast_arena->make<TreeBinaryExpr>(OP_Add, $1, $3);
         }
         | AddExp Minus MulExp{
-                                $$ = new TreeBinaryExpr(OP_Sub, $1, $3);
+                                $$ = ast_arena->make<TreeBinaryExpr>(OP_Sub, $1, $3);
         }
         ;
 
@@ -318,26 +313,26 @@ RelExp : AddExp {
                                 $$ = $1;
 }
         | RelExp Lt AddExp {
-                                $$ = new TreeBinaryExpr(OP_Lt, $1, $3);
+                                $$ = ast_arena->make<TreeBinaryExpr>(OP_Lt, $1, $3);
         }
         | RelExp Gt AddExp {
-                                $$ = new TreeBinaryExpr(OP_Gt, $1, $3);
+                                $$ = ast_arena->make<TreeBinaryExpr>(OP_Gt, $1, $3);
         }
         | RelExp Lte AddExp {
-                                $$ = new TreeBinaryExpr(OP_Le, $1, $3);
+                                $$ = ast_arena->make<TreeBinaryExpr>(OP_Le, $1, $3);
         }
         | RelExp Gte AddExp {
-                                $$ = new TreeBinaryExpr(OP_Ge, $1, $3);
+                                $$ = ast_arena->make<TreeBinaryExpr>(OP_Ge, $1, $3);
         }
 
 EqExp : RelExp {
                                 $$ = $1;
 }
         | EqExp Eq RelExp {
-                                $$ = new TreeBinaryExpr(OP_Eq, $1, $3);
+                                $$ = ast_arena->make<TreeBinaryExpr>(OP_Eq, $1, $3);
         }
         | EqExp Neq RelExp {
-                                $$ = new TreeBinaryExpr(OP_Ne, $1, $3);
+                                $$ = ast_arena->make<TreeBinaryExpr>(OP_Ne, $1, $3);
         }
         ;
 
@@ -345,7 +340,7 @@ LAndExp : EqExp {
                                 $$ = $1;
 }
         | LAndExp And EqExp {
-                                $$ = new TreeBinaryExpr(OP_Land, $1, $3);
+                                $$ = ast_arena->make<TreeBinaryExpr>(OP_Land, $1, $3);
         }
         ;
 
@@ -353,7 +348,7 @@ LOrExp : LAndExp {
                                 $$ = $1;
 }
         | LOrExp Or LAndExp {
-                                $$ = new TreeBinaryExpr(OP_Lor, $1, $3);
+                                $$ = ast_arena->make<TreeBinaryExpr>(OP_Lor, $1, $3);
         }
         ;
 
@@ -362,5 +357,5 @@ LOrExp : LAndExp {
 
 void yyerror(const char* s)
 {
-    printf("\n\033[1;31m%s at line %d\033[0m: %s\n",s,yylineno,yytext);
+    LOG_ERROR(LC_Parser, "\n\033[1;31m{} at line {}\033[0m: {}\n", s, yylineno, yytext);
 }